@@ -5,6 +5,7 @@
 #include <bench/bench.h>
 #include <checkqueue.h>
 #include <common/system.h>
+#include <crypto/sha256.h>
 #include <key.h>
 #include <prevector.h>
 #include <pubkey.h>
@@ -65,3 +66,41 @@ static void CCheckQueueSpeedPrevectorJob(benchmark::Bench& bench)
     ECC_Stop();
 }
 BENCHMARK(CCheckQueueSpeedPrevectorJob, benchmark::PriorityLevel::HIGH);
+
+// Scaling of the CheckQueue with the number of threads (the master counts as
+// one), with checks that take about as long as hashing a transaction input.
+static void CCheckQueueScaling(benchmark::Bench& bench, int threads)
+{
+    struct HashJob {
+        unsigned char data[CSHA256::OUTPUT_SIZE]{};
+        bool operator()()
+        {
+            for (int i = 0; i < 16; ++i) {
+                CSHA256().Write(data, sizeof(data)).Finalize(data);
+            }
+            return true;
+        }
+    };
+    CCheckQueue<HashJob> queue{QUEUE_BATCH_SIZE};
+    queue.StartWorkerThreads(threads - 1);
+
+    bench.name(strprintf("%s with %d threads", __func__, threads));
+    bench.batch(BATCH_SIZE * BATCHES).unit("job").run([&] {
+        CCheckQueueControl<HashJob> control(&queue);
+        for (size_t i = 0; i < BATCHES; ++i) {
+            control.Add(std::vector<HashJob>(BATCH_SIZE));
+        }
+        control.Wait();
+    });
+    queue.StopWorkerThreads();
+}
+
+static void CCheckQueueScaling1(benchmark::Bench& bench) { CCheckQueueScaling(bench, 1); }
+static void CCheckQueueScaling4(benchmark::Bench& bench) { CCheckQueueScaling(bench, 4); }
+static void CCheckQueueScaling16(benchmark::Bench& bench) { CCheckQueueScaling(bench, 16); }
+static void CCheckQueueScaling64(benchmark::Bench& bench) { CCheckQueueScaling(bench, 64); }
+
+BENCHMARK(CCheckQueueScaling1, benchmark::PriorityLevel::LOW);
+BENCHMARK(CCheckQueueScaling4, benchmark::PriorityLevel::LOW);
+BENCHMARK(CCheckQueueScaling16, benchmark::PriorityLevel::LOW);
+BENCHMARK(CCheckQueueScaling64, benchmark::PriorityLevel::LOW);
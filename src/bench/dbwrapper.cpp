@@ -0,0 +1,71 @@
+// Copyright (c) 2023 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <dbwrapper.h>
+#include <node/database_args.h>
+#include <random.h>
+#include <test/util/setup_common.h>
+#include <tinyformat.h>
+#include <uint256.h>
+#include <util/fs.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Chainstate-like LevelDB workload used to compare the -dbprofile settings.
+ *
+ * Writes COUNT small records keyed by a random 32-byte hash in batches, the
+ * way coins are flushed, then performs point lookups of which half miss.
+ */
+static void DBWrapperProfile(benchmark::Bench& bench, node::DBProfile profile)
+{
+    static constexpr uint32_t COUNT{50'000};
+    static constexpr uint32_t BATCH_SIZE{5'000};
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>()};
+    DBOptions options;
+    node::ApplyDBProfile(profile, options);
+
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<std::pair<uint256, uint32_t>> keys;
+    keys.reserve(COUNT);
+    for (uint32_t i = 0; i < COUNT; ++i) keys.emplace_back(rng.rand256(), i);
+    const std::vector<unsigned char> value(40, 0x5a);
+
+    uint64_t run{0};
+    bench.batch(COUNT).unit("record").run([&] {
+        CDBWrapper dbw({.path = testing_setup->m_path_root / fs::u8path(strprintf("db%d", run++)),
+                        .cache_bytes = 8 << 20,
+                        .wipe_data = true,
+                        .obfuscate = true,
+                        .options = options});
+        CDBBatch batch{dbw};
+        for (uint32_t i = 0; i < COUNT; ++i) {
+            batch.Write(keys[i], value);
+            if ((i + 1) % BATCH_SIZE == 0) {
+                dbw.WriteBatch(batch);
+                batch.Clear();
+            }
+        }
+        std::vector<unsigned char> read;
+        for (uint32_t i = 0; i < COUNT; ++i) {
+            if (i % 2 == 0) {
+                dbw.Read(keys[i], read);
+            } else {
+                dbw.Exists(std::make_pair(rng.rand256(), i));
+            }
+        }
+    });
+}
+
+static void DBWrapperProfileDefault(benchmark::Bench& bench) { DBWrapperProfile(bench, node::DBProfile::DEFAULT); }
+static void DBWrapperProfileSSD(benchmark::Bench& bench) { DBWrapperProfile(bench, node::DBProfile::SSD); }
+static void DBWrapperProfileLowMem(benchmark::Bench& bench) { DBWrapperProfile(bench, node::DBProfile::LOWMEM); }
+
+BENCHMARK(DBWrapperProfileDefault, benchmark::PriorityLevel::LOW);
+BENCHMARK(DBWrapperProfileSSD, benchmark::PriorityLevel::LOW);
+BENCHMARK(DBWrapperProfileLowMem, benchmark::PriorityLevel::LOW);
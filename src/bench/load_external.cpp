@@ -20,9 +20,11 @@
  * from disk later when it encounters its parent.)
  *
  * This benchmark measures the performance of deserializing the block (or just
- * its header, beginning with PR 16981).
+ * its header, beginning with PR 16981). With gap bytes, each block is preceded
+ * by data in which the first magic byte occurs often, as in files with
+ * unused or corrupted space, to measure scanning for the magic bytes.
  */
-static void LoadExternalBlockFile(benchmark::Bench& bench)
+static void LoadExternalBlockFileBench(benchmark::Bench& bench, size_t gap_bytes)
 {
     const auto testing_setup{MakeNoLogFileContext<const TestingSetup>(ChainType::MAIN)};
 
@@ -31,6 +33,9 @@ static void LoadExternalBlockFile(benchmark::Bench& bench)
     const fs::path blkfile{testing_setup.get()->m_path_root / "blk.dat"};
     DataStream ss{};
     auto params{testing_setup->m_node.chainman->GetParams()};
+    for (size_t i = 0; i < gap_bytes; ++i) {
+        ss << (i % 16 == 0 ? params.MessageStart()[0] : uint8_t{0});
+    }
     ss << params.MessageStart();
     ss << static_cast<uint32_t>(benchmark::data::block413567.size());
     // We can't use the streaming serialization (ss << benchmark::data::block413567)
@@ -61,4 +66,15 @@ static void LoadExternalBlockFile(benchmark::Bench& bench)
     fs::remove(blkfile);
 }
 
+static void LoadExternalBlockFile(benchmark::Bench& bench)
+{
+    LoadExternalBlockFileBench(bench, /*gap_bytes=*/0);
+}
+
+static void LoadExternalBlockFileGaps(benchmark::Bench& bench)
+{
+    LoadExternalBlockFileBench(bench, /*gap_bytes=*/64 << 10);
+}
+
 BENCHMARK(LoadExternalBlockFile, benchmark::PriorityLevel::HIGH);
+BENCHMARK(LoadExternalBlockFileGaps, benchmark::PriorityLevel::HIGH);
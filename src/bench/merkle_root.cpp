@@ -5,6 +5,8 @@
 #include <bench/bench.h>
 
 #include <consensus/merkle.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
 #include <random.h>
 #include <uint256.h>
 
@@ -23,4 +25,34 @@ static void MerkleRoot(benchmark::Bench& bench)
     });
 }
 
+// Both merkle roots of a block, computed one after the other or together.
+static void BlockMerkleRootsBench(benchmark::Bench& bench, bool fused)
+{
+    FastRandomContext rng(true);
+    CBlock block;
+    for (int i = 0; i < 3001; ++i) {
+        CMutableTransaction mtx;
+        mtx.vin.resize(1);
+        mtx.vin[0].prevout.hash = rng.rand256();
+        mtx.vin[0].scriptWitness.stack.push_back(rng.randbytes(72));
+        block.vtx.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+    bench.batch(block.vtx.size()).unit("tx").run([&] {
+        bool mutated = false;
+        uint256 root, witness_root;
+        if (fused) {
+            std::tie(root, witness_root) = BlockMerkleRoots(block, &mutated);
+        } else {
+            root = BlockMerkleRoot(block, &mutated);
+            witness_root = BlockWitnessMerkleRoot(block);
+        }
+        assert(!mutated && root != witness_root);
+    });
+}
+
+static void BlockMerkleRootsSeparate(benchmark::Bench& bench) { BlockMerkleRootsBench(bench, /*fused=*/false); }
+static void BlockMerkleRootsFused(benchmark::Bench& bench) { BlockMerkleRootsBench(bench, /*fused=*/true); }
+
 BENCHMARK(MerkleRoot, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockMerkleRootsSeparate, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockMerkleRootsFused, benchmark::PriorityLevel::HIGH);
@@ -7,9 +7,11 @@
 #include <streams.h>
 #include <util/fs.h>
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <vector>
 
 static void FindByte(benchmark::Bench& bench)
 {
@@ -32,4 +34,29 @@ static void FindByte(benchmark::Bench& bench)
     fs::remove("streams_tmp");
 }
 
+static void FindBytes(benchmark::Bench& bench)
+{
+    // Setup: a 1 MiB buffer in which the first byte of the sequence occurs
+    // every 256 bytes, as a mismatch, before the sequence at the end.
+    CAutoFile file{fsbridge::fopen("streams_tmp", "w+b"), 0};
+    const size_t file_size = 1 << 20;
+    const std::array<std::byte, 4> find{std::byte{0xf9}, std::byte{0xbe}, std::byte{0xb4}, std::byte{0xd9}};
+    std::vector<std::byte> data(file_size);
+    for (size_t i = 0; i < file_size; i += 256) data[i] = find[0];
+    std::copy(find.begin(), find.end(), data.end() - find.size());
+    file << Span{data};
+    std::rewind(file.Get());
+    BufferedFile bf{file, /*nBufSize=*/file_size + 1, /*nRewindIn=*/file_size};
+
+    bench.batch(file_size).unit("byte").run([&] {
+        bf.SetPos(0);
+        bf.FindBytes(find);
+    });
+
+    // Cleanup
+    file.fclose();
+    fs::remove("streams_tmp");
+}
+
 BENCHMARK(FindByte, benchmark::PriorityLevel::HIGH);
+BENCHMARK(FindBytes, benchmark::PriorityLevel::HIGH);
@@ -4,14 +4,18 @@
 
 #include <bench/bench.h>
 #include <key.h>
+#include <pubkey.h>
 #if defined(HAVE_CONSENSUS_LIB)
 #include <script/ocvcoinconsensus.h>
 #endif
 #include <script/script.h>
 #include <script/interpreter.h>
 #include <streams.h>
+#include <test/util/setup_common.h>
 #include <test/util/transaction_utils.h>
+#include <validation.h>
 
+#include <algorithm>
 #include <array>
 
 // Microbenchmark for verification of a basic P2WPKH script. Can be easily
@@ -95,5 +99,110 @@ static void VerifyNestedIfScript(benchmark::Bench& bench)
     });
 }
 
+namespace {
+//! Accepts every signature, so that only the script handling is measured.
+class AcceptingSignatureChecker : public BaseSignatureChecker
+{
+public:
+    bool CheckECDSASignature(const std::vector<unsigned char>& sig, const std::vector<unsigned char>& pubkey, const CScript& script_code, SigVersion sigversion) const override
+    {
+        return true;
+    }
+};
+} // namespace
+
+// Script handling of a P2PKH spend, leaving out the signature check itself:
+// through the VerifyScript fast path, or through the interpreter.
+static void VerifyP2PKHScript(benchmark::Bench& bench, bool interpreter)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>();
+    const uint32_t flags{SCRIPT_VERIFY_WITNESS | SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_STRICTENC | SCRIPT_VERIFY_DERSIG | SCRIPT_VERIFY_LOW_S};
+
+    CKey key;
+    key.MakeNewKey(true);
+    const CPubKey pubkey{key.GetPubKey()};
+    std::vector<unsigned char> sig;
+    bool ok{key.Sign(uint256::ONE, sig)};
+    assert(ok);
+    sig.push_back(static_cast<unsigned char>(SIGHASH_ALL));
+    const CScript script_pubkey{CScript() << OP_DUP << OP_HASH160 << ToByteVector(pubkey.GetID()) << OP_EQUALVERIFY << OP_CHECKSIG};
+    const CScript script_sig{CScript() << sig << ToByteVector(pubkey)};
+    const AcceptingSignatureChecker checker;
+
+    bench.unit("input").run([&] {
+        ScriptError err;
+        bool success;
+        if (interpreter) {
+            std::vector<std::vector<unsigned char>> stack;
+            success = EvalScript(stack, script_sig, flags, checker, SigVersion::BASE, &err) &&
+                      EvalScript(stack, script_pubkey, flags, checker, SigVersion::BASE, &err) &&
+                      stack.size() == 1;
+        } else {
+            success = VerifyScript(script_sig, script_pubkey, nullptr, flags, checker, &err);
+        }
+        assert(success);
+    });
+}
+
+static void VerifyP2PKHFastPath(benchmark::Bench& bench) { VerifyP2PKHScript(bench, /*interpreter=*/false); }
+static void VerifyP2PKHInterpreter(benchmark::Bench& bench) { VerifyP2PKHScript(bench, /*interpreter=*/true); }
+
+// Verification of a transaction with 100 taproot key path spends, as done by
+// the script check queue: one by one, or with the signatures batched.
+static void VerifyTaprootKeyPathBatch(benchmark::Bench& bench, bool batch)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>();
+    static constexpr int NUM_INPUTS{100};
+    const uint32_t flags{SCRIPT_VERIFY_WITNESS | SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_TAPROOT};
+
+    std::vector<CKey> keys(NUM_INPUTS);
+    CMutableTransaction tx_credit;
+    tx_credit.vin.resize(1);
+    for (CKey& key : keys) {
+        key.MakeNewKey(true);
+        const XOnlyPubKey output_key{XOnlyPubKey{key.GetPubKey()}.CreateTapTweak(nullptr)->first};
+        tx_credit.vout.emplace_back(1, CScript() << OP_1 << ToByteVector(output_key));
+    }
+    const CTransaction credit{tx_credit};
+
+    CMutableTransaction tx_spend;
+    for (int i = 0; i < NUM_INPUTS; ++i) {
+        tx_spend.vin.emplace_back(COutPoint{credit.GetHash(), static_cast<uint32_t>(i)});
+    }
+    tx_spend.vout.emplace_back(NUM_INPUTS, CScript() << OP_TRUE);
+    PrecomputedTransactionData sign_txdata;
+    sign_txdata.Init(tx_spend, std::vector<CTxOut>{credit.vout}, /*force=*/true);
+    for (int i = 0; i < NUM_INPUTS; ++i) {
+        ScriptExecutionData execdata;
+        execdata.m_annex_init = true;
+        execdata.m_annex_present = false;
+        uint256 sighash;
+        bool ok{SignatureHashSchnorr(sighash, execdata, tx_spend, i, SIGHASH_DEFAULT, SigVersion::TAPROOT, sign_txdata, MissingDataBehavior::FAIL)};
+        std::vector<unsigned char> sig(64);
+        ok = ok && keys[i].SignSchnorr(sighash, sig, nullptr, uint256{});
+        assert(ok);
+        tx_spend.vin[i].scriptWitness.stack.push_back(std::move(sig));
+    }
+    const CTransaction spend{tx_spend};
+    PrecomputedTransactionData txdata;
+    txdata.Init(spend, std::vector<CTxOut>{credit.vout});
+
+    bench.unit("input").batch(NUM_INPUTS).run([&] {
+        std::vector<CScriptCheck> checks;
+        for (int i = 0; i < NUM_INPUTS; ++i) {
+            checks.emplace_back(credit.vout[i], spend, i, flags, /*cacheIn=*/false, &txdata);
+        }
+        const bool success{batch ? RunChecks(checks) : std::all_of(checks.begin(), checks.end(), [](CScriptCheck& check) { return check(); })};
+        assert(success);
+    });
+}
+
+static void VerifyTaprootKeyPathIndividual(benchmark::Bench& bench) { VerifyTaprootKeyPathBatch(bench, /*batch=*/false); }
+static void VerifyTaprootKeyPathBatched(benchmark::Bench& bench) { VerifyTaprootKeyPathBatch(bench, /*batch=*/true); }
+
 BENCHMARK(VerifyScriptBench, benchmark::PriorityLevel::HIGH);
 BENCHMARK(VerifyNestedIfScript, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyP2PKHFastPath, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyP2PKHInterpreter, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyTaprootKeyPathIndividual, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyTaprootKeyPathBatched, benchmark::PriorityLevel::HIGH);
@@ -10,12 +10,28 @@
 #include <util/threadnames.h>
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <iterator>
+#include <memory>
+#include <thread>
 #include <vector>
 
 template <typename T>
 class CCheckQueueControl;
 
+/**
+ * Run a batch of checks, stopping at the first failure. A check type can
+ * overload this (it is found through argument-dependent lookup) to verify
+ * its checks together more efficiently than one by one.
+ */
+template <typename T>
+bool RunChecks(std::vector<T>& checks)
+{
+    return std::all_of(checks.begin(), checks.end(), [](T& check) { return check(); });
+}
+
 /**
  * Queue for verifications that have to be performed.
   * The verifications are represented by a type T, which must provide an
@@ -25,12 +41,25 @@ class CCheckQueueControl;
   * onto the queue, where they are processed by N-1 worker threads. When
   * the master is done adding work, it temporarily joins the worker pool
   * as an N'th worker, until all jobs are done.
+  *
+  * Every worker (and the master) has its own queue, which Add() fills in
+  * turn. A worker takes batches from the back of its own queue, and when
+  * that is empty, steals half of another queue from its front. Each queue
+  * has its own mutex, so workers only contend when stealing; m_mutex is
+  * only taken to sleep and wake up.
   */
 template <typename T>
 class CCheckQueue
 {
 private:
-    //! Mutex to protect the inner state
+    //! The queue of one worker (index 0 belongs to the master).
+    struct WorkerQueue {
+        Mutex m_mutex;
+        //! The owner takes elements from the back, others steal from the front.
+        std::deque<T> m_checks GUARDED_BY(m_mutex);
+    };
+
+    //! Mutex to sleep on and to protect the stop request
     Mutex m_mutex;
 
     //! Worker threads block on this when out of work
@@ -39,25 +68,25 @@ private:
     //! Master thread blocks on this when out of work
     std::condition_variable m_master_cv;
 
-    //! The queue of elements to be processed.
-    //! As the order of booleans doesn't matter, it is used as a LIFO (stack)
-    std::vector<T> queue GUARDED_BY(m_mutex);
+    //! One queue per thread, the master's first. Only resized while no
+    //! worker threads run.
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
 
-    //! The number of workers (including the master) that are idle.
-    int nIdle GUARDED_BY(m_mutex){0};
+    //! Index of the queue that the next call to Add() starts filling.
+    size_t m_next_queue{0};
 
-    //! The total number of workers (including the master).
-    int nTotal GUARDED_BY(m_mutex){0};
-
-    //! The temporary evaluation result.
-    bool fAllOk GUARDED_BY(m_mutex){true};
+    //! The number of elements in all queues.
+    std::atomic<unsigned int> m_queued{0};
 
     /**
      * Number of verifications that haven't completed yet.
      * This includes elements that are no longer queued, but still in the
-     * worker's own batches.
+     * worker's own batches, as those must be destroyed before Wait() returns.
      */
-    unsigned int nTodo GUARDED_BY(m_mutex){0};
+    std::atomic<unsigned int> m_todo{0};
+
+    //! The temporary evaluation result.
+    std::atomic<bool> m_all_ok{true};
 
     //! The maximum number of elements to be processed in one batch
     const unsigned int nBatchSize;
@@ -65,64 +94,69 @@ private:
     std::vector<std::thread> m_worker_threads;
     bool m_request_stop GUARDED_BY(m_mutex){false};
 
+    /** Move up to max elements from the back (own queue) or the front (stolen) of queue into checks. */
+    void TakeFrom(WorkerQueue& queue, std::vector<T>& checks, bool steal) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(queue.m_mutex);
+        auto& elems{queue.m_checks};
+        if (elems.empty()) return;
+        // Take smaller batches from a shorter queue, so all workers finish
+        // at about the same time; thieves take half of what is left.
+        const size_t n{std::max<size_t>(1, std::min<size_t>(nBatchSize, elems.size() / (steal ? 2 : m_queues.size())))};
+        const auto first{steal ? elems.begin() : elems.end() - n};
+        checks.assign(std::make_move_iterator(first), std::make_move_iterator(first + n));
+        elems.erase(first, first + n);
+        m_queued.fetch_sub(n, std::memory_order_relaxed);
+    }
+
+    /** Get a batch of work for the thread with queue index, from its own queue or from another one. */
+    bool Take(size_t index, std::vector<T>& checks) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        TakeFrom(*m_queues[index], checks, /*steal=*/false);
+        for (size_t i{1}; checks.empty() && i < m_queues.size() && m_queued.load(std::memory_order_relaxed) > 0; ++i) {
+            TakeFrom(*m_queues[(index + i) % m_queues.size()], checks, /*steal=*/true);
+        }
+        return !checks.empty();
+    }
+
+    /** Run a batch of checks, and destroy them before marking them as done. */
+    void Process(std::vector<T>& checks) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        // Check whether we need to do work at all
+        const bool ok{m_all_ok.load(std::memory_order_relaxed) && RunChecks(checks)};
+        if (!ok) m_all_ok.store(false, std::memory_order_relaxed);
+        const unsigned int n = checks.size();
+        checks.clear();
+        if (m_todo.fetch_sub(n, std::memory_order_acq_rel) == n) {
+            // We processed the last element; inform the master it can exit and return the result
+            WITH_LOCK(m_mutex, m_master_cv.notify_one());
+        }
+    }
+
     /** Internal function that does bulk of the verification work. */
-    bool Loop(bool fMaster) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    bool Loop(bool fMaster, size_t index) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
-        std::condition_variable& cond = fMaster ? m_master_cv : m_worker_cv;
         std::vector<T> vChecks;
         vChecks.reserve(nBatchSize);
-        unsigned int nNow = 0;
-        bool fOk = true;
-        do {
-            {
-                WAIT_LOCK(m_mutex, lock);
-                // first do the clean-up of the previous loop run (allowing us to do it in the same critsect)
-                if (nNow) {
-                    fAllOk &= fOk;
-                    nTodo -= nNow;
-                    if (nTodo == 0 && !fMaster)
-                        // We processed the last element; inform the master it can exit and return the result
-                        m_master_cv.notify_one();
-                } else {
-                    // first iteration
-                    nTotal++;
-                }
-                // logically, the do loop starts here
-                while (queue.empty() && !m_request_stop) {
-                    if (fMaster && nTodo == 0) {
-                        nTotal--;
-                        bool fRet = fAllOk;
-                        // reset the status for new work later
-                        fAllOk = true;
-                        // return the current status
-                        return fRet;
-                    }
-                    nIdle++;
-                    cond.wait(lock); // wait
-                    nIdle--;
-                }
-                if (m_request_stop) {
-                    return false;
+        while (true) {
+            if (Take(index, vChecks)) {
+                Process(vChecks);
+                continue;
+            }
+            WAIT_LOCK(m_mutex, lock);
+            if (fMaster) {
+                // Only the master adds work, so once nothing is queued, wait
+                // for the batches the workers are still processing.
+                m_master_cv.wait(lock, [&] { return m_todo.load() == 0 || m_queued.load() > 0; });
+                if (m_todo.load() == 0) {
+                    // reset the status for new work later, and return the current status
+                    return m_all_ok.exchange(true);
                 }
-
-                // Decide how many work units to process now.
-                // * Do not try to do everything at once, but aim for increasingly smaller batches so
-                //   all workers finish approximately simultaneously.
-                // * Try to account for idle jobs which will instantly start helping.
-                // * Don't do batches smaller than 1 (duh), or larger than nBatchSize.
-                nNow = std::max(1U, std::min(nBatchSize, (unsigned int)queue.size() / (nTotal + nIdle + 1)));
-                auto start_it = queue.end() - nNow;
-                vChecks.assign(std::make_move_iterator(start_it), std::make_move_iterator(queue.end()));
-                queue.erase(start_it, queue.end());
-                // Check whether we need to do work at all
-                fOk = fAllOk;
+            } else {
+                m_worker_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_request_stop || m_queued.load() > 0; });
+                if (m_request_stop) return false;
             }
-            // execute work
-            for (T& check : vChecks)
-                if (fOk)
-                    fOk = check();
-            vChecks.clear();
-        } while (true);
+        }
     }
 
 public:
@@ -133,22 +167,23 @@ public:
     explicit CCheckQueue(unsigned int nBatchSizeIn)
         : nBatchSize(nBatchSizeIn)
     {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
     }
 
     //! Create a pool of new worker threads.
     void StartWorkerThreads(const int threads_num) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
-        {
-            LOCK(m_mutex);
-            nIdle = 0;
-            nTotal = 0;
-            fAllOk = true;
-        }
         assert(m_worker_threads.empty());
+        m_all_ok = true;
+        m_next_queue = 0;
+        m_queues.resize(1);
+        for (int n = 0; n < threads_num; ++n) {
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+        }
         for (int n = 0; n < threads_num; ++n) {
             m_worker_threads.emplace_back([this, n]() {
                 util::ThreadRename(strprintf("scriptch.%i", n));
-                Loop(false /* worker thread */);
+                Loop(false /* worker thread */, n + 1);
             });
         }
     }
@@ -156,7 +191,7 @@ public:
     //! Wait until execution finishes, and return whether all evaluations were successful.
     bool Wait() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
-        return Loop(true /* master thread */);
+        return Loop(true /* master thread */, 0);
     }
 
     //! Add a batch of checks to the queue
@@ -166,12 +201,23 @@ public:
             return;
         }
 
-        {
-            LOCK(m_mutex);
-            queue.insert(queue.end(), std::make_move_iterator(vChecks.begin()), std::make_move_iterator(vChecks.end()));
-            nTodo += vChecks.size();
+        // Spread large batches over all queues, in chunks of at most nBatchSize.
+        const size_t chunk{std::clamp<size_t>((vChecks.size() + m_queues.size() - 1) / m_queues.size(), 1, nBatchSize)};
+        m_todo.fetch_add(vChecks.size(), std::memory_order_relaxed);
+        // Count the checks before publishing them, so a thief that takes some
+        // of them right away can not wrap m_queued around.
+        m_queued.fetch_add(vChecks.size(), std::memory_order_relaxed);
+        for (auto it{vChecks.begin()}; it != vChecks.end();) {
+            const auto end{it + std::min<size_t>(chunk, vChecks.end() - it)};
+            WorkerQueue& queue{*m_queues[m_next_queue]};
+            m_next_queue = (m_next_queue + 1) % m_queues.size();
+            WITH_LOCK(queue.m_mutex, queue.m_checks.insert(queue.m_checks.end(), std::make_move_iterator(it), std::make_move_iterator(end)));
+            it = end;
         }
 
+        // Taking the lock makes sure a worker that saw an empty queue is
+        // waiting on m_worker_cv before it is notified.
+        { LOCK(m_mutex); }
         if (vChecks.size() == 1) {
             m_worker_cv.notify_one();
         } else {
@@ -188,6 +234,8 @@ public:
             t.join();
         }
         m_worker_threads.clear();
+        m_queues.resize(1);
+        m_next_queue = 0;
         WITH_LOCK(m_mutex, m_request_stop = false);
     }
 
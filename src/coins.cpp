@@ -300,6 +300,15 @@ unsigned int CCoinsViewCache::GetCacheSize() const {
     return cacheCoins.size();
 }
 
+std::vector<COutPoint> CCoinsViewCache::GetCachedOutPoints() const {
+    std::vector<COutPoint> outpoints;
+    outpoints.reserve(cacheCoins.size());
+    for (const auto& [outpoint, entry] : cacheCoins) {
+        if (!entry.coin.IsSpent()) outpoints.push_back(outpoint);
+    }
+    return outpoints;
+}
+
 bool CCoinsViewCache::HaveInputs(const CTransaction& tx) const
 {
     if (!tx.IsCoinBase()) {
@@ -20,6 +20,7 @@
 
 #include <functional>
 #include <unordered_map>
+#include <vector>
 
 /**
  * A UTXO entry.
@@ -327,6 +328,9 @@ public:
     //! Calculate the size of the cache (in number of transaction outputs)
     unsigned int GetCacheSize() const;
 
+    //! Return the outpoints of all unspent coins currently held in this cache.
+    std::vector<COutPoint> GetCachedOutPoints() const;
+
     //! Calculate the size of the cache (in bytes)
     size_t DynamicMemoryUsage() const;
 
@@ -7,6 +7,7 @@
 #define OCVCOIN_COMPRESSOR_H
 
 #include <prevector.h>
+#include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <script/script.h>
 #include <serialize.h>
@@ -115,4 +116,78 @@ struct TxOutCompression
     FORMATTER_METHODS(CTxOut, obj) { READWRITE(Using<AmountCompression>(obj.nValue), Using<ScriptCompression>(obj.scriptPubKey)); }
 };
 
+/** wrapper for CTxIn that provides a more compact serialization, used for compressed block files */
+struct TxInCompression
+{
+    template<typename Stream>
+    void Ser(Stream& s, const CTxIn& txin)
+    {
+        // Most inputs use one of the highest sequence numbers
+        s << txin.prevout.hash << VARINT(txin.prevout.n) << txin.scriptSig << VARINT(~txin.nSequence);
+    }
+
+    template<typename Stream>
+    void Unser(Stream& s, CTxIn& txin)
+    {
+        uint32_t inv_sequence;
+        s >> txin.prevout.hash >> VARINT(txin.prevout.n) >> txin.scriptSig >> VARINT(inv_sequence);
+        txin.nSequence = ~inv_sequence;
+    }
+};
+
+/**
+ * wrapper for CTransactionRef that provides a more compact serialization,
+ * used for compressed block files. Outputs use TxOutCompression, so it only
+ * round-trips outputs with amounts in MoneyRange and scripts of at most
+ * MAX_SCRIPT_SIZE bytes.
+ */
+struct TxCompression
+{
+    template<typename Stream>
+    void Ser(Stream& s, const CTransactionRef& tx)
+    {
+        const bool has_witness{tx->HasWitness()};
+        s << VARINT(static_cast<uint32_t>(tx->nVersion)) << has_witness;
+        s << Using<VectorFormatter<TxInCompression>>(tx->vin);
+        s << Using<VectorFormatter<TxOutCompression>>(tx->vout);
+        if (has_witness) {
+            for (const CTxIn& txin : tx->vin) s << txin.scriptWitness.stack;
+        }
+        s << VARINT(tx->nLockTime);
+    }
+
+    template<typename Stream>
+    void Unser(Stream& s, CTransactionRef& tx)
+    {
+        CMutableTransaction mtx;
+        uint32_t version;
+        bool has_witness;
+        s >> VARINT(version) >> has_witness;
+        mtx.nVersion = static_cast<int32_t>(version);
+        s >> Using<VectorFormatter<TxInCompression>>(mtx.vin);
+        s >> Using<VectorFormatter<TxOutCompression>>(mtx.vout);
+        if (has_witness) {
+            for (CTxIn& txin : mtx.vin) s >> txin.scriptWitness.stack;
+        }
+        s >> VARINT(mtx.nLockTime);
+        tx = MakeTransactionRef(std::move(mtx));
+    }
+};
+
+/** wrapper for CBlock that provides a more compact serialization, used for compressed block files */
+struct BlockCompression
+{
+    template<typename Stream>
+    void Ser(Stream& s, const CBlock& block)
+    {
+        s << AsBase<CBlockHeader>(block) << Using<VectorFormatter<TxCompression>>(block.vtx);
+    }
+
+    template<typename Stream>
+    void Unser(Stream& s, CBlock& block)
+    {
+        s >> AsBase<CBlockHeader>(block) >> Using<VectorFormatter<TxCompression>>(block.vtx);
+    }
+};
+
 #endif // OCVCOIN_COMPRESSOR_H
@@ -83,3 +83,38 @@ uint256 BlockWitnessMerkleRoot(const CBlock& block, bool* mutated)
     return ComputeMerkleRoot(std::move(leaves), mutated);
 }
 
+std::pair<uint256, uint256> BlockMerkleRoots(const CBlock& block, bool* mutated)
+{
+    // The transaction tree is kept in the first half of hashes and the witness
+    // tree in the second half. Both have the same number of leaves, so every
+    // level of both trees can be hashed with a single SHA256D64 call.
+    size_t level_size{block.vtx.size()};
+    std::vector<uint256> hashes;
+    hashes.reserve(2 * level_size + 2);
+    hashes.resize(2 * level_size);
+    for (size_t s = 0; s < level_size; s++) {
+        hashes[s] = block.vtx[s]->GetHash();
+        // The witness hash of the coinbase is 0.
+        if (s > 0) hashes[level_size + s] = block.vtx[s]->GetWitnessHash();
+    }
+
+    bool mutation = false;
+    while (level_size > 1) {
+        if (mutated) {
+            for (size_t pos = 0; pos + 1 < level_size; pos += 2) {
+                if (hashes[pos] == hashes[pos + 1]) mutation = true;
+            }
+        }
+        if (level_size & 1) {
+            hashes.insert(hashes.begin() + level_size, hashes[level_size - 1]);
+            hashes.push_back(hashes.back());
+            ++level_size;
+        }
+        SHA256D64(hashes[0].begin(), hashes[0].begin(), level_size);
+        level_size /= 2;
+        hashes.resize(2 * level_size);
+    }
+    if (mutated) *mutated = mutation;
+    if (level_size == 0) return {uint256(), uint256()};
+    return {hashes[0], hashes[1]};
+}
@@ -5,6 +5,7 @@
 #ifndef OCVCOIN_CONSENSUS_MERKLE_H
 #define OCVCOIN_CONSENSUS_MERKLE_H
 
+#include <utility>
 #include <vector>
 
 #include <primitives/block.h>
@@ -24,4 +25,12 @@ uint256 BlockMerkleRoot(const CBlock& block, bool* mutated = nullptr);
  */
 uint256 BlockWitnessMerkleRoot(const CBlock& block, bool* mutated = nullptr);
 
+/*
+ * Compute the Merkle roots of the transactions and of the witness transactions
+ * in a block together, in one pass over the transactions and hashing each level
+ * of both trees at once, so that more hashes run in parallel SIMD lanes.
+ * *mutated is set to true if a duplicated subtree was found in the transaction tree.
+ */
+std::pair<uint256, uint256> BlockMerkleRoots(const CBlock& block, bool* mutated = nullptr);
+
 #endif // OCVCOIN_CONSENSUS_MERKLE_H
@@ -484,6 +484,21 @@ public:
             }
         return false;
     }
+
+    /** for_each_live calls fn on every element which has not been marked for
+     * garbage collection, e.g. to persist the cache.
+     *
+     * for_each_live must not run concurrently with insert.
+     *
+     * @param fn a function taking a const Element&
+     */
+    template <typename Fn>
+    void for_each_live(Fn&& fn) const
+    {
+        for (uint32_t i = 0; i < size; ++i) {
+            if (!collection_flags.bit_is_set(i)) fn(table[i]);
+        }
+    }
 };
 } // namespace CuckooCache
 
@@ -134,13 +134,18 @@ static void SetMaxOpenFiles(leveldb::Options *options) {
              options->max_open_files, default_open_files);
 }
 
-static leveldb::Options GetOptions(size_t nCacheSize)
+static leveldb::Options GetOptions(size_t nCacheSize, const DBOptions& db_options)
 {
     leveldb::Options options;
-    options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
-    options.write_buffer_size = nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
-    options.filter_policy = leveldb::NewBloomFilterPolicy(10);
-    options.compression = leveldb::kNoCompression;
+    const size_t write_buffer_size{db_options.write_buffer_size.value_or(nCacheSize / 4)};
+    // Up to two write buffers may be held in memory simultaneously; the rest
+    // of the budget goes to the block cache, which always keeps at least a quarter.
+    options.block_cache = leveldb::NewLRUCache(std::max(nCacheSize / 4, nCacheSize - std::min(nCacheSize, 2 * write_buffer_size)));
+    options.write_buffer_size = write_buffer_size;
+    options.filter_policy = db_options.bloom_filter_bits > 0 ? leveldb::NewBloomFilterPolicy(db_options.bloom_filter_bits) : nullptr;
+    options.block_size = db_options.block_size;
+    options.max_file_size = db_options.max_file_size;
+    options.compression = db_options.compression ? leveldb::kSnappyCompression : leveldb::kNoCompression;
     options.info_log = new COcvcoinLevelDBLogger();
     if (leveldb::kMajorVersion > 1 || (leveldb::kMajorVersion == 1 && leveldb::kMinorVersion >= 16)) {
         // LevelDB versions before 1.16 consider short writes to be corruption. Only trigger error
@@ -226,7 +231,7 @@ CDBWrapper::CDBWrapper(const DBParams& params)
     DBContext().iteroptions.verify_checksums = true;
     DBContext().iteroptions.fill_cache = false;
     DBContext().syncoptions.sync = true;
-    DBContext().options = GetOptions(params.cache_bytes);
+    DBContext().options = GetOptions(params.cache_bytes, params.options);
     DBContext().options.create_if_missing = true;
     if (params.memory_only) {
         DBContext().penv = leveldb::NewMemEnv(leveldb::Env::Default());
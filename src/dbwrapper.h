@@ -27,6 +27,18 @@ static const size_t DBWRAPPER_PREALLOC_VALUE_SIZE = 1024;
 struct DBOptions {
     //! Compact database on startup.
     bool force_compact = false;
+    //! Bits per key used by the leveldb bloom filter (0 disables the filter).
+    int bloom_filter_bits = 10;
+    //! Approximate amount of user data packed per leveldb table block.
+    size_t block_size = 4 << 10;
+    //! Size of the leveldb write buffer. If unset, a quarter of
+    //! DBParams::cache_bytes is used.
+    std::optional<size_t> write_buffer_size{};
+    //! Size at which leveldb starts a new table file.
+    size_t max_file_size = 2 << 20;
+    //! Request snappy compression of table blocks. Has no effect if leveldb
+    //! was built without snappy support, in which case blocks are stored raw.
+    bool compression = false;
 };
 
 //! Application-specific storage settings.
@@ -0,0 +1,223 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/blockstatsindex.h>
+
+#include <chain.h>
+#include <common/args.h>
+#include <consensus/consensus.h>
+#include <consensus/validation.h>
+#include <dbwrapper.h>
+#include <index/db_key.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <serialize.h>
+#include <undo.h>
+#include <util/check.h>
+#include <validation.h>
+#include <version.h>
+
+#include <algorithm>
+
+using index_util::DBHeightKey;
+
+// Approximate size of a coin in the UTXO set on top of its serialized output:
+// the outpoint it is keyed by, nHeight and fCoinBase
+static constexpr size_t PER_UTXO_OVERHEAD = sizeof(COutPoint) + sizeof(uint32_t) + sizeof(bool);
+
+namespace {
+
+template<typename T>
+T CalculateTruncatedMedian(std::vector<T>& scores)
+{
+    size_t size = scores.size();
+    if (size == 0) {
+        return 0;
+    }
+
+    std::sort(scores.begin(), scores.end());
+    if (size % 2 == 0) {
+        return (scores[size / 2 - 1] + scores[size / 2]) / 2;
+    } else {
+        return scores[size / 2];
+    }
+}
+
+} // namespace
+
+std::unique_ptr<BlockStatsIndex> g_block_stats_index;
+
+void CalculatePercentilesByWeight(CAmount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<CAmount, int64_t>>& scores, int64_t total_weight)
+{
+    if (scores.empty()) {
+        return;
+    }
+
+    std::sort(scores.begin(), scores.end());
+
+    // 10th, 25th, 50th, 75th, and 90th percentile weight units.
+    const double weights[NUM_GETBLOCKSTATS_PERCENTILES] = {
+        total_weight / 10.0, total_weight / 4.0, total_weight / 2.0, (total_weight * 3.0) / 4.0, (total_weight * 9.0) / 10.0
+    };
+
+    int64_t next_percentile_index = 0;
+    int64_t cumulative_weight = 0;
+    for (const auto& element : scores) {
+        cumulative_weight += element.second;
+        while (next_percentile_index < NUM_GETBLOCKSTATS_PERCENTILES && cumulative_weight >= weights[next_percentile_index]) {
+            result[next_percentile_index] = element.first;
+            ++next_percentile_index;
+        }
+    }
+
+    // Fill any remaining percentiles with the last value.
+    for (int64_t i = next_percentile_index; i < NUM_GETBLOCKSTATS_PERCENTILES; i++) {
+        result[i] = scores.back().first;
+    }
+}
+
+BlockStats ComputeBlockStats(const CBlock& block, const CBlockUndo& block_undo, const CBlockIndex& block_index)
+{
+    BlockStats stats;
+    stats.txs = block.vtx.size();
+
+    CAmount maxfee = 0;
+    CAmount maxfeerate = 0;
+    CAmount minfee = MAX_MONEY;
+    CAmount minfeerate = MAX_MONEY;
+    int64_t maxtxsize = 0;
+    int64_t mintxsize = MAX_BLOCK_SERIALIZED_SIZE;
+    std::vector<CAmount> fee_array;
+    std::vector<std::pair<CAmount, int64_t>> feerate_array;
+    std::vector<int64_t> txsize_array;
+
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        const auto& tx = block.vtx.at(i);
+        stats.outs += tx->vout.size();
+
+        CAmount tx_total_out = 0;
+        for (const CTxOut& out : tx->vout) {
+            tx_total_out += out.nValue;
+
+            size_t out_size = GetSerializeSize(out, PROTOCOL_VERSION) + PER_UTXO_OVERHEAD;
+            stats.utxo_size_inc += out_size;
+
+            // The Genesis block and the repeated BIP30 block coinbases don't change the UTXO
+            // set counts, so they have to be excluded from the statistics
+            if (block_index.nHeight == 0 || (IsBIP30Repeat(block_index) && tx->IsCoinBase())) continue;
+            // Skip unspendable outputs since they are not included in the UTXO set
+            if (out.scriptPubKey.IsUnspendable()) continue;
+
+            ++stats.utxos;
+            stats.utxo_size_inc_actual += out_size;
+        }
+
+        if (tx->IsCoinBase()) {
+            continue;
+        }
+
+        stats.ins += tx->vin.size(); // Don't count coinbase's fake input
+        stats.total_out += tx_total_out; // Don't count coinbase reward
+
+        const int64_t tx_size = tx->GetTotalSize();
+        txsize_array.push_back(tx_size);
+        maxtxsize = std::max(maxtxsize, tx_size);
+        mintxsize = std::min(mintxsize, tx_size);
+        stats.total_size += tx_size;
+
+        const int64_t weight = GetTransactionWeight(*tx);
+        stats.total_weight += weight;
+
+        if (tx->HasWitness()) {
+            ++stats.swtxs;
+            stats.swtotal_size += tx_size;
+            stats.swtotal_weight += weight;
+        }
+
+        CAmount tx_total_in = 0;
+        const auto& txundo = block_undo.vtxundo.at(i - 1);
+        for (const Coin& coin: txundo.vprevout) {
+            const CTxOut& prevoutput = coin.out;
+
+            tx_total_in += prevoutput.nValue;
+            size_t prevout_size = GetSerializeSize(prevoutput, PROTOCOL_VERSION) + PER_UTXO_OVERHEAD;
+            stats.utxo_size_inc -= prevout_size;
+            stats.utxo_size_inc_actual -= prevout_size;
+        }
+
+        CAmount txfee = tx_total_in - tx_total_out;
+        CHECK_NONFATAL(MoneyRange(txfee));
+        fee_array.push_back(txfee);
+        maxfee = std::max(maxfee, txfee);
+        minfee = std::min(minfee, txfee);
+        stats.totalfee += txfee;
+
+        // New feerate uses satoshis per virtual byte instead of per serialized byte
+        CAmount feerate = weight ? (txfee * WITNESS_SCALE_FACTOR) / weight : 0;
+        feerate_array.emplace_back(feerate, weight);
+        maxfeerate = std::max(maxfeerate, feerate);
+        minfeerate = std::min(minfeerate, feerate);
+    }
+
+    CalculatePercentilesByWeight(stats.feerate_percentiles.data(), feerate_array, stats.total_weight);
+
+    stats.maxfee = maxfee;
+    stats.maxfeerate = maxfeerate;
+    stats.maxtxsize = maxtxsize;
+    stats.medianfee = CalculateTruncatedMedian(fee_array);
+    stats.mediantxsize = CalculateTruncatedMedian(txsize_array);
+    stats.minfee = (minfee == MAX_MONEY) ? 0 : minfee;
+    stats.minfeerate = (minfeerate == MAX_MONEY) ? 0 : minfeerate;
+    stats.mintxsize = mintxsize == MAX_BLOCK_SERIALIZED_SIZE ? 0 : mintxsize;
+    return stats;
+}
+
+BlockStatsIndex::BlockStatsIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "blockstatsindex")
+{
+    fs::path path{gArgs.GetDataDirNet() / "indexes" / "blockstats"};
+    fs::create_directories(path);
+
+    m_db = std::make_unique<BlockStatsIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe);
+}
+
+bool BlockStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    const CBlockIndex* pindex = WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash));
+
+    // The genesis block has no undo data
+    CBlockUndo block_undo;
+    if (block.height > 0 && !m_chainstate->m_blockman.UndoReadFromDisk(block_undo, *pindex)) {
+        return false;
+    }
+
+    assert(block.data);
+    const std::pair<uint256, BlockStats> value{block.hash, ComputeBlockStats(*block.data, block_undo, *pindex)};
+    return m_db->Write(DBHeightKey(block.height), value);
+}
+
+bool BlockStatsIndex::CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip)
+{
+    CDBBatch batch(*m_db);
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+
+    // During a reorg, we need to copy all stats for blocks that are getting
+    // disconnected from the height index to the hash index so we can still
+    // find them when the height index entries are overwritten.
+    if (!index_util::CopyHeightIndexToHashIndex<BlockStats>(*db_it, batch, m_name, new_tip.height, current_tip.height)) {
+        return false;
+    }
+
+    return m_db->WriteBatch(batch);
+}
+
+std::optional<BlockStats> BlockStatsIndex::LookUpStats(const CBlockIndex& block_index) const
+{
+    BlockStats stats;
+    if (!index_util::LookUpOne(*m_db, {block_index.GetBlockHash(), block_index.nHeight}, stats)) {
+        return std::nullopt;
+    }
+    return stats;
+}
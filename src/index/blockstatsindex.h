@@ -0,0 +1,107 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OCVCOIN_INDEX_BLOCKSTATSINDEX_H
+#define OCVCOIN_INDEX_BLOCKSTATSINDEX_H
+
+#include <consensus/amount.h>
+#include <index/base.h>
+#include <serialize.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+class CBlock;
+class CBlockIndex;
+class CBlockUndo;
+
+static constexpr bool DEFAULT_BLOCKSTATSINDEX{false};
+
+static constexpr int NUM_GETBLOCKSTATS_PERCENTILES = 5;
+
+/** Used by getblockstats to get feerates at different percentiles by weight  */
+void CalculatePercentilesByWeight(CAmount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<CAmount, int64_t>>& scores, int64_t total_weight);
+
+/**
+ * The per block statistics of getblockstats that need the block and undo
+ * data. All amounts are in satoshis, feerates in satoshis per virtual byte.
+ * Fields that only need the block index (time, subsidy, ...) are not included.
+ */
+struct BlockStats {
+    int64_t txs{0};
+    int64_t ins{0};
+    int64_t outs{0};
+    CAmount total_out{0};
+    int64_t total_size{0};
+    int64_t total_weight{0};
+    int64_t swtxs{0};
+    int64_t swtotal_size{0};
+    int64_t swtotal_weight{0};
+    CAmount totalfee{0};
+    CAmount minfee{0};
+    CAmount maxfee{0};
+    CAmount medianfee{0};
+    CAmount minfeerate{0};
+    CAmount maxfeerate{0};
+    std::array<CAmount, NUM_GETBLOCKSTATS_PERCENTILES> feerate_percentiles{};
+    int64_t mintxsize{0};
+    int64_t maxtxsize{0};
+    int64_t mediantxsize{0};
+    //! Number of new outputs, not counting unspendables
+    int64_t utxos{0};
+    int64_t utxo_size_inc{0};
+    int64_t utxo_size_inc_actual{0};
+
+    SERIALIZE_METHODS(BlockStats, obj)
+    {
+        // All values but the utxo size changes are non-negative
+        using VarInt = VarIntFormatter<VarIntMode::NONNEGATIVE_SIGNED>;
+        READWRITE(Using<VarInt>(obj.txs), Using<VarInt>(obj.ins), Using<VarInt>(obj.outs), Using<VarInt>(obj.total_out));
+        READWRITE(Using<VarInt>(obj.total_size), Using<VarInt>(obj.total_weight));
+        READWRITE(Using<VarInt>(obj.swtxs), Using<VarInt>(obj.swtotal_size), Using<VarInt>(obj.swtotal_weight));
+        READWRITE(Using<VarInt>(obj.totalfee), Using<VarInt>(obj.minfee), Using<VarInt>(obj.maxfee), Using<VarInt>(obj.medianfee));
+        READWRITE(Using<VarInt>(obj.minfeerate), Using<VarInt>(obj.maxfeerate));
+        for (auto& feerate : obj.feerate_percentiles) READWRITE(Using<VarInt>(feerate));
+        READWRITE(Using<VarInt>(obj.mintxsize), Using<VarInt>(obj.maxtxsize), Using<VarInt>(obj.mediantxsize));
+        READWRITE(Using<VarInt>(obj.utxos), obj.utxo_size_inc, obj.utxo_size_inc_actual);
+    }
+};
+
+/** Compute the statistics of a block, given its undo data (empty for the genesis block). */
+BlockStats ComputeBlockStats(const CBlock& block, const CBlockUndo& block_undo, const CBlockIndex& block_index);
+
+/**
+ * BlockStatsIndex keeps the getblockstats statistics of every block, so they
+ * can be looked up without reading the block and its undo data.
+ */
+class BlockStatsIndex final : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+
+    bool AllowPrune() const override { return true; }
+
+protected:
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+public:
+    // Constructs the index, which becomes available to be queried.
+    explicit BlockStatsIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Look up the stats of a specific block using CBlockIndex
+    std::optional<BlockStats> LookUpStats(const CBlockIndex& block_index) const;
+};
+
+/// The global block statistics index. May be null.
+extern std::unique_ptr<BlockStatsIndex> g_block_stats_index;
+
+#endif // OCVCOIN_INDEX_BLOCKSTATSINDEX_H
@@ -9,6 +9,7 @@
 #include <index/disktxpos.h>
 #include <logging.h>
 #include <node/blockstorage.h>
+#include <primitives/block.h>
 #include <validation.h>
 
 constexpr uint8_t DB_TXINDEX{'t'};
@@ -79,6 +80,23 @@ bool TxIndex::FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRe
         return false;
     }
 
+    if (m_chainstate->m_blockman.IsCompressedBlockRecord(postx)) {
+        // nTxOffset is relative to the network serialization, which a
+        // compressed record does not contain, so decode the whole block.
+        CBlock block;
+        if (!m_chainstate->m_blockman.ReadBlockFromDisk(block, postx)) {
+            return error("%s: ReadBlockFromDisk failed", __func__);
+        }
+        for (const auto& block_tx : block.vtx) {
+            if (block_tx->GetHash() == tx_hash) {
+                tx = block_tx;
+                block_hash = block.GetHash();
+                return true;
+            }
+        }
+        return error("%s: txid not found in block", __func__);
+    }
+
     CAutoFile file{m_chainstate->m_blockman.OpenBlockFile(postx, true)};
     if (file.IsNull()) {
         return error("%s: OpenBlockFile failed", __func__);
@@ -8,12 +8,18 @@
 #include <kernel/notifications_interface.h>
 #include <util/fs.h>
 
+#include <cstddef>
 #include <cstdint>
 
 class CChainParams;
 
 namespace kernel {
 
+/** Default for -blockfilemaps, the number of block files kept memory-mapped for reads. */
+static constexpr int DEFAULT_BLOCKFILE_MAPS{sizeof(void*) >= 8 ? 64 : 0};
+/** Default for -undocache, the memory in MiB for caching recently read block undo data. */
+static constexpr int64_t DEFAULT_UNDO_CACHE_MB{16};
+
 /**
  * An options struct for `BlockManager`, more ergonomically referred to as
  * `BlockManager::Options` due to the using-declaration in `BlockManager`.
@@ -22,6 +28,11 @@ struct BlockManagerOpts {
     const CChainParams& chainparams;
     uint64_t prune_target{0};
     bool fast_prune{false};
+    int blockfile_maps{DEFAULT_BLOCKFILE_MAPS};
+    bool block_compression{false};
+    bool async_writes{false};
+    bool background_prune{false};
+    size_t undo_cache_bytes{DEFAULT_UNDO_CACHE_MB << 20};
     const fs::path blocks_dir;
     Notifications& notifications;
 };
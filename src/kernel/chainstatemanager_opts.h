@@ -21,6 +21,14 @@ class CChainParams;
 
 static constexpr bool DEFAULT_CHECKPOINTS_ENABLED{true};
 static constexpr auto DEFAULT_MAX_TIP_AGE{24h};
+//! -loadblockbuffer default, in MiB
+static constexpr int64_t DEFAULT_LOADBLOCK_BUFFER_MB{32};
+//! -loadblockbuffer maximum, in MiB
+static constexpr int64_t MAX_LOADBLOCK_BUFFER_MB{1024};
+//! -blockprefetch default, the number of blocks loaded ahead of the tip
+static constexpr int DEFAULT_BLOCK_PREFETCH{8};
+//! -blockprefetch maximum
+static constexpr int MAX_BLOCK_PREFETCH{64};
 
 namespace kernel {
 
@@ -41,6 +49,10 @@ struct ChainstateManagerOpts {
     std::optional<uint256> assumed_valid_block{};
     //! If the tip is older than this, the node is considered to be in initial block download.
     std::chrono::seconds max_tip_age{DEFAULT_MAX_TIP_AGE};
+    //! Size of the read buffer used by LoadExternalBlockFile, at least twice the maximum block size.
+    size_t loadblock_buffer_bytes{DEFAULT_LOADBLOCK_BUFFER_MB << 20};
+    //! Number of blocks about to be connected to load and check on background threads (0 = disabled).
+    int block_prefetch{DEFAULT_BLOCK_PREFETCH};
     DBOptions block_tree_db{};
     DBOptions coins_db{};
     CoinsViewOptions coins_view{};
@@ -0,0 +1,151 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <kernel/coinscache_persist.h>
+
+#include <clientversion.h>
+#include <coins.h>
+#include <logging.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <streams.h>
+#include <sync.h>
+#include <txdb.h>
+#include <util/fs.h>
+#include <util/fs_helpers.h>
+#include <util/signalinterrupt.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+using fsbridge::FopenFn;
+
+namespace kernel {
+
+static const uint64_t COINSCACHE_DUMP_VERSION = 1;
+
+//! Number of outpoints read from disk before cs_main is taken to fetch them.
+static constexpr size_t COINSCACHE_LOAD_BATCH{1000};
+
+bool LoadCoinsCache(Chainstate& chainstate, const fs::path& load_path, FopenFn mockable_fopen_function)
+{
+    if (load_path.empty()) return false;
+
+    FILE* filestr{mockable_fopen_function(load_path, "rb")};
+    CAutoFile file{filestr, CLIENT_VERSION};
+    if (file.IsNull()) {
+        LogPrintf("Failed to open coins cache file from disk. Continuing anyway.\n");
+        return false;
+    }
+
+    auto start = SteadyClock::now();
+    uint64_t loaded = 0;
+    uint64_t missing = 0;
+    bool cache_full = false;
+
+    try {
+        uint64_t version;
+        file >> version;
+        if (version != COINSCACHE_DUMP_VERSION) {
+            return false;
+        }
+        uint64_t num;
+        file >> num;
+
+        std::vector<COutPoint> batch;
+        batch.reserve(COINSCACHE_LOAD_BATCH);
+        while (num > 0 && !cache_full) {
+            batch.clear();
+            while (num > 0 && batch.size() < COINSCACHE_LOAD_BATCH) {
+                file >> batch.emplace_back();
+                --num;
+            }
+
+            LOCK(cs_main);
+            if (chainstate.GetCoinsCacheSizeState() != CoinsCacheSizeState::OK) {
+                cache_full = true;
+                break;
+            }
+            const CCoinsViewCache& coins_cache{chainstate.CoinsTip()};
+            for (const COutPoint& outpoint : batch) {
+                if (coins_cache.AccessCoin(outpoint).IsSpent()) {
+                    ++missing;
+                } else {
+                    ++loaded;
+                }
+            }
+
+            if (chainstate.m_chainman.m_interrupt) return false;
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to deserialize coins cache data on disk: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+
+    LogPrintf("Loaded coins cache from disk: %i coins cached, %i no longer unspent%s, %gs\n",
+              loaded, missing, cache_full ? ", stopped early as the cache is full" : "",
+              Ticks<SecondsDouble>(SteadyClock::now() - start));
+    return true;
+}
+
+bool DumpCoinsCache(Chainstate& chainstate, const fs::path& dump_path, FopenFn mockable_fopen_function, bool skip_file_commit)
+{
+    auto start = SteadyClock::now();
+
+    std::vector<COutPoint> outpoints;
+    {
+        LOCK(cs_main);
+        // The chainstate may not have been loaded, e.g. when shutting down
+        // after an error during init.
+        if (!chainstate.CanFlushToDisk()) return false;
+        outpoints = chainstate.CoinsTip().GetCachedOutPoints();
+    }
+    // Write in coins database key order, so that loading walks the database
+    // mostly sequentially.
+    std::sort(outpoints.begin(), outpoints.end(), CoinsDBKeyLess);
+
+    auto mid = SteadyClock::now();
+
+    try {
+        FILE* filestr{mockable_fopen_function(dump_path + ".new", "wb")};
+        if (!filestr) {
+            return false;
+        }
+
+        CAutoFile file{filestr, CLIENT_VERSION};
+
+        uint64_t version = COINSCACHE_DUMP_VERSION;
+        file << version;
+
+        file << (uint64_t)outpoints.size();
+        for (const COutPoint& outpoint : outpoints) {
+            file << outpoint;
+        }
+
+        if (!skip_file_commit && !FileCommit(file.Get()))
+            throw std::runtime_error("FileCommit failed");
+        file.fclose();
+        if (!RenameOver(dump_path + ".new", dump_path)) {
+            throw std::runtime_error("Rename failed");
+        }
+        auto last = SteadyClock::now();
+
+        LogPrintf("Dumped %d coins cache entries: %gs to copy, %gs to dump\n",
+                  outpoints.size(),
+                  Ticks<SecondsDouble>(mid - start),
+                  Ticks<SecondsDouble>(last - mid));
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to dump coins cache: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+    return true;
+}
+
+} // namespace kernel
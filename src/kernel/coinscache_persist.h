@@ -0,0 +1,34 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OCVCOIN_KERNEL_COINSCACHE_PERSIST_H
+#define OCVCOIN_KERNEL_COINSCACHE_PERSIST_H
+
+#include <util/fs.h>
+
+class Chainstate;
+
+namespace kernel {
+
+/**
+ * Dump the outpoints of the coins held in the chainstate's coins tip cache
+ * to a file. Must be called before the cache is flushed on shutdown, as a
+ * flush empties it. Does nothing if the chainstate's coins views are not
+ * initialized.
+ */
+bool DumpCoinsCache(Chainstate& chainstate, const fs::path& dump_path,
+                    fsbridge::FopenFn mockable_fopen_function = fsbridge::fopen,
+                    bool skip_file_commit = false);
+
+/**
+ * Read outpoints from the file and pull the corresponding coins from the
+ * coins database into the chainstate's coins tip cache. Stops early when the
+ * cache is getting full.
+ */
+bool LoadCoinsCache(Chainstate& chainstate, const fs::path& load_path,
+                    fsbridge::FopenFn mockable_fopen_function = fsbridge::fopen);
+
+} // namespace kernel
+
+#endif // OCVCOIN_KERNEL_COINSCACHE_PERSIST_H
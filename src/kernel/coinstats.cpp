@@ -20,16 +20,22 @@
 #include <uint256.h>
 #include <util/check.h>
 #include <util/overflow.h>
+#include <util/threadnames.h>
 #include <validation.h>
 #include <version.h>
 
+#include <algorithm>
 #include <cassert>
+#include <condition_variable>
+#include <deque>
 #include <iosfwd>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 namespace kernel {
 
@@ -56,7 +62,7 @@ static void TxOutSer(T& ss, const COutPoint& outpoint, const Coin& coin)
     ss << coin.out;
 }
 
-static void ApplyCoinHash(HashWriter& ss, const COutPoint& outpoint, const Coin& coin)
+void ApplyCoinHash(HashWriter& ss, const COutPoint& outpoint, const Coin& coin)
 {
     TxOutSer(ss, outpoint, coin);
 }
@@ -77,6 +83,115 @@ void RemoveCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& c
 
 static void ApplyCoinHash(std::nullptr_t, const COutPoint& outpoint, const Coin& coin) {}
 
+/**
+ * MuHash3072 accumulator that hashes coins on worker threads.
+ *
+ * Coins are handed to the workers in batches, and each worker folds them into
+ * its own MuHash3072. As MuHash is commutative, combining the per-worker
+ * accumulators gives the same result as inserting every coin into one, while
+ * the caller keeps reading the UTXO set from a single database snapshot.
+ */
+class ParallelMuHash
+{
+public:
+    explicit ParallelMuHash(int num_threads) : m_accumulators(num_threads)
+    {
+        for (int n = 0; n < num_threads; ++n) {
+            m_threads.emplace_back([this, n]() {
+                util::ThreadRename(strprintf("utxohash.%i", n));
+                Loop(m_accumulators[n]);
+            });
+        }
+    }
+
+    ~ParallelMuHash() { Stop(); }
+
+    void Add(const COutPoint& outpoint, const Coin& coin) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        m_batch.emplace_back(outpoint, coin);
+        if (m_batch.size() >= BATCH_SIZE) Flush();
+    }
+
+    //! Wait for all queued coins to be hashed and return the combined hash.
+    MuHash3072 Finish() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        Flush();
+        Stop();
+        MuHash3072 result;
+        for (const MuHash3072& accumulator : m_accumulators) {
+            result *= accumulator;
+        }
+        return result;
+    }
+
+private:
+    using Batch = std::vector<std::pair<COutPoint, Coin>>;
+
+    static constexpr size_t BATCH_SIZE{1024};
+
+    Mutex m_mutex;
+    //! Signalled when a batch is queued or the workers should stop.
+    std::condition_variable m_work_cv;
+    //! Signalled when a worker takes a batch off the queue.
+    std::condition_variable m_space_cv;
+    std::deque<Batch> m_queue GUARDED_BY(m_mutex);
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+
+    Batch m_batch;
+    std::vector<MuHash3072> m_accumulators;
+    std::vector<std::thread> m_threads;
+
+    void Flush() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        if (m_batch.empty()) return;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            // Bound the memory used by coins that were read but not hashed yet.
+            m_space_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_queue.size() < 2 * m_threads.size(); });
+            m_queue.push_back(std::move(m_batch));
+        }
+        m_work_cv.notify_one();
+        m_batch.clear();
+    }
+
+    //! Ask the workers to exit once the queue is drained, and wait for them.
+    void Stop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WITH_LOCK(m_mutex, m_request_stop = true);
+        m_work_cv.notify_all();
+        for (std::thread& t : m_threads) {
+            t.join();
+        }
+        m_threads.clear();
+    }
+
+    void Loop(MuHash3072& accumulator) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            Batch batch;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_work_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return !m_queue.empty() || m_request_stop; });
+                if (m_queue.empty()) return;
+                batch = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            m_space_cv.notify_one();
+            for (const auto& [outpoint, coin] : batch) {
+                ApplyCoinHash(accumulator, outpoint, coin);
+            }
+        }
+    }
+};
+
+static void ApplyCoinHash(ParallelMuHash& muhash, const COutPoint& outpoint, const Coin& coin)
+{
+    muhash.Add(outpoint, coin);
+}
+
+//! Upper bound on the number of threads hashing the UTXO set with MuHash.
+static constexpr unsigned int MAX_UTXO_HASH_THREADS{16};
+
 //! Warning: be very careful when changing this! assumeutxo and UTXO snapshot
 //! validation commitments are reliant on the hash constructed by this
 //! function.
@@ -114,7 +229,7 @@ static void ApplyStats(CCoinsStats& stats, const uint256& hash, const std::map<u
 
 //! Calculate statistics about the unspent transaction output set
 template <typename T>
-static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point)
+static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T&& hash_obj, const std::function<void()>& interruption_point)
 {
     std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
     assert(pcursor);
@@ -163,7 +278,9 @@ std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsV
             return ComputeUTXOStats(view, stats, ss, interruption_point);
         }
         case(CoinStatsHashType::MUHASH): {
-            MuHash3072 muhash;
+            // The cursor is read on this thread; the hashing, which dominates
+            // the cost of MuHash, is spread across the available cores.
+            ParallelMuHash muhash{static_cast<int>(std::clamp(std::thread::hardware_concurrency(), 1U, MAX_UTXO_HASH_THREADS))};
             return ComputeUTXOStats(view, stats, muhash, interruption_point);
         }
         case(CoinStatsHashType::NONE): {
@@ -189,6 +306,11 @@ static void FinalizeHash(MuHash3072& muhash, CCoinsStats& stats)
     muhash.Finalize(out);
     stats.hashSerialized = out;
 }
+static void FinalizeHash(ParallelMuHash& muhash, CCoinsStats& stats)
+{
+    MuHash3072 combined{muhash.Finish()};
+    FinalizeHash(combined, stats);
+}
 static void FinalizeHash(std::nullptr_t, CCoinsStats& stats) {}
 
 } // namespace kernel
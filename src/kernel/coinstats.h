@@ -16,6 +16,7 @@
 
 class CCoinsView;
 class Coin;
+class HashWriter;
 class COutPoint;
 class CScript;
 namespace node {
@@ -73,6 +74,9 @@ struct CCoinsStats {
 
 uint64_t GetBogoSize(const CScript& script_pub_key);
 
+//! Append a coin to a HASH_SERIALIZED stream. Coins must be applied in
+//! coins database order to reproduce the hash computed by ComputeUTXOStats().
+void ApplyCoinHash(HashWriter& ss, const COutPoint& outpoint, const Coin& coin);
 void ApplyCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin);
 void RemoveCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin);
 
@@ -0,0 +1,126 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <kernel/validation_cache_persist.h>
+
+#include <clientversion.h>
+#include <logging.h>
+#include <script/sigcache.h>
+#include <serialize.h>
+#include <streams.h>
+#include <sync.h>
+#include <uint256.h>
+#include <util/fs.h>
+#include <util/fs_helpers.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+using fsbridge::FopenFn;
+
+namespace kernel {
+
+static const uint64_t VALIDATION_CACHE_DUMP_VERSION = 2;
+
+bool LoadValidationCaches(const fs::path& load_path, FopenFn mockable_fopen_function)
+{
+    if (load_path.empty()) return false;
+
+    FILE* filestr{mockable_fopen_function(load_path, "rb")};
+    CAutoFile file{filestr, CLIENT_VERSION};
+    if (file.IsNull()) {
+        LogPrintf("Failed to open validation cache file from disk. Continuing anyway.\n");
+        return false;
+    }
+
+    auto start = SteadyClock::now();
+    int client_version;
+    uint256 sig_nonce, script_nonce;
+    std::vector<uint256> sig_entries, script_entries;
+
+    // Read the whole file before touching the caches, so that a truncated
+    // file leaves them with their fresh salts.
+    try {
+        uint64_t version;
+        file >> version;
+        if (version != VALIDATION_CACHE_DUMP_VERSION) {
+            LogPrintf("Validation cache file has unsupported version %d. Continuing anyway.\n", version);
+            return false;
+        }
+        file >> client_version;
+        file >> sig_nonce >> sig_entries;
+        file >> script_nonce >> script_entries;
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to deserialize validation cache data on disk: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+
+    // A script execution cache entry only says that a transaction passed the
+    // script checks of the version that added it, which another version may
+    // not agree with. Signature validity does not change between versions.
+    LoadSignatureCacheEntries(sig_nonce, sig_entries);
+    if (client_version != CLIENT_VERSION) {
+        LogPrintf("Discarding %i script executions cached by client version %d\n", script_entries.size(), client_version);
+        script_entries.clear();
+    } else {
+        LOCK(cs_main);
+        LoadScriptExecutionCacheEntries(script_nonce, script_entries);
+    }
+
+    LogPrintf("Loaded validation caches from disk: %i signatures, %i script executions, %gs\n",
+              sig_entries.size(), script_entries.size(),
+              Ticks<SecondsDouble>(SteadyClock::now() - start));
+    return true;
+}
+
+bool DumpValidationCaches(const fs::path& dump_path, FopenFn mockable_fopen_function, bool skip_file_commit)
+{
+    auto start = SteadyClock::now();
+
+    std::vector<uint256> sig_entries, script_entries;
+    const uint256 sig_nonce{GetSignatureCacheEntries(sig_entries)};
+    const uint256 script_nonce{WITH_LOCK(cs_main, return GetScriptExecutionCacheEntries(script_entries))};
+
+    auto mid = SteadyClock::now();
+
+    try {
+        FILE* filestr{mockable_fopen_function(dump_path + ".new", "wb")};
+        if (!filestr) {
+            return false;
+        }
+
+        CAutoFile file{filestr, CLIENT_VERSION};
+
+        uint64_t version = VALIDATION_CACHE_DUMP_VERSION;
+        file << version;
+        file << int{CLIENT_VERSION};
+
+        file << sig_nonce << sig_entries;
+        file << script_nonce << script_entries;
+
+        if (!skip_file_commit && !FileCommit(file.Get()))
+            throw std::runtime_error("FileCommit failed");
+        file.fclose();
+        if (!RenameOver(dump_path + ".new", dump_path)) {
+            throw std::runtime_error("Rename failed");
+        }
+        auto last = SteadyClock::now();
+
+        LogPrintf("Dumped %d signature and %d script execution cache entries: %gs to copy, %gs to dump\n",
+                  sig_entries.size(), script_entries.size(),
+                  Ticks<SecondsDouble>(mid - start),
+                  Ticks<SecondsDouble>(last - mid));
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to dump validation caches: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+    return true;
+}
+
+} // namespace kernel
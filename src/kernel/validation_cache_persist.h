@@ -0,0 +1,31 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OCVCOIN_KERNEL_VALIDATION_CACHE_PERSIST_H
+#define OCVCOIN_KERNEL_VALIDATION_CACHE_PERSIST_H
+
+#include <util/fs.h>
+
+namespace kernel {
+
+/**
+ * Dump the salts and live entries of the signature cache and the
+ * script-execution cache to a file.
+ */
+bool DumpValidationCaches(const fs::path& dump_path,
+                          fsbridge::FopenFn mockable_fopen_function = fsbridge::fopen,
+                          bool skip_file_commit = false);
+
+/**
+ * Restore the salts and entries of the signature cache and the
+ * script-execution cache from a file. Must be called after the caches are
+ * initialized and before anything is validated with them. Script executions
+ * are only restored if the file was written by the same CLIENT_VERSION.
+ */
+bool LoadValidationCaches(const fs::path& load_path,
+                          fsbridge::FopenFn mockable_fopen_function = fsbridge::fopen);
+
+} // namespace kernel
+
+#endif // OCVCOIN_KERNEL_VALIDATION_CACHE_PERSIST_H
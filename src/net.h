@@ -126,12 +126,31 @@ struct CSerializedNetMsg {
         CSerializedNetMsg copy;
         copy.data = data;
         copy.m_type = m_type;
+        copy.m_external_owner = m_external_owner;
+        copy.m_external_data = m_external_data;
         return copy;
     }
 
     std::vector<unsigned char> data;
     std::string m_type;
 
+    /**
+     * Optional payload living outside of data, e.g. a block viewed in a
+     * memory-mapped block file. When set, it is sent instead of data without
+     * being copied. m_external_owner keeps the memory alive.
+     */
+    std::shared_ptr<const void> m_external_owner;
+    Span<const unsigned char> m_external_data;
+
+    /** The payload bytes to send. */
+    Span<const unsigned char> Payload() const noexcept
+    {
+        return m_external_owner ? m_external_data : Span<const unsigned char>{data};
+    }
+
+    /** Release the payload once it has been handed off or sent. */
+    void ClearPayload() noexcept;
+
     /** Compute total memory usage of this object (own memory + any dynamic memory). */
     size_t GetMemoryUsage() const noexcept;
 };
@@ -2290,11 +2290,20 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
     } else if (inv.IsMsgWitnessBlk()) {
         // Fast-path: in this case it is possible to serve the block directly from disk,
         // as the network format matches the format on disk
-        std::vector<uint8_t> block_data;
-        if (!m_chainman.m_blockman.ReadRawBlockFromDisk(block_data, pindex->GetBlockPos())) {
-            assert(!"cannot load block from disk");
+        if (auto view{m_chainman.m_blockman.ReadRawBlockView(pindex->GetBlockPos())}) {
+            // Send the block straight from the mapped block file, without copying it
+            CSerializedNetMsg msg;
+            msg.m_type = NetMsgType::BLOCK;
+            msg.m_external_data = UCharSpanCast(view->data);
+            msg.m_external_owner = std::move(view->file);
+            m_connman.PushMessage(&pfrom, std::move(msg));
+        } else {
+            std::vector<uint8_t> block_data;
+            if (!m_chainman.m_blockman.ReadRawBlockFromDisk(block_data, pindex->GetBlockPos())) {
+                assert(!"cannot load block from disk");
+            }
+            m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::BLOCK, Span{block_data}));
         }
-        m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::BLOCK, Span{block_data}));
         // Don't set pblock as we've sent the block
     } else {
         // Send block from disk
@@ -4685,7 +4694,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         }
 
         std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
-        vRecv >> *pblock;
+        UnserializeBlock(vRecv, *pblock);
 
         LogPrint(BCLog::NET, "received block %s peer=%d\n", pblock->GetHash().ToString(), pfrom.GetId());
 
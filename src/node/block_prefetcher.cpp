@@ -0,0 +1,144 @@
+// Copyright (c) 2023 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/block_prefetcher.h>
+
+#include <chain.h>
+#include <primitives/block.h>
+#include <sync.h>
+#include <tinyformat.h>
+#include <util/thread.h>
+
+#include <algorithm>
+
+namespace node {
+
+BlockPrefetcher::BlockPrefetcher(LoadFn load, int num_threads, size_t max_blocks)
+    : m_load{std::move(load)},
+      m_max_blocks{max_blocks}
+{
+    for (int n = 0; n < num_threads; ++n) {
+        m_threads.emplace_back([this, n]() {
+            util::TraceThread(strprintf("prefetch.%i", n), [this] { ThreadLoad(); });
+        });
+    }
+}
+
+BlockPrefetcher::~BlockPrefetcher()
+{
+    WITH_LOCK(m_mutex, m_stop = true);
+    m_cv.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void BlockPrefetcher::Prefetch(const std::vector<std::pair<const CBlockIndex*, FlatFilePos>>& blocks)
+{
+    {
+        LOCK(m_mutex);
+        std::map<uint256, Entry> entries;
+        std::deque<uint256> queue;
+        m_pending.clear();
+        for (const auto& [index, pos] : blocks) {
+            if (entries.size() >= m_max_blocks) {
+                m_pending.emplace_back(index, pos);
+                continue;
+            }
+            const uint256 hash{index->GetBlockHash()};
+            if (auto it{m_entries.find(hash)}; it != m_entries.end()) {
+                if (!it->second.loading && !it->second.loaded) queue.push_back(hash);
+                entries.insert(m_entries.extract(it));
+            } else if (auto [new_it, inserted]{entries.try_emplace(hash)}; inserted) {
+                new_it->second.index = index;
+                new_it->second.pos = pos;
+                queue.push_back(hash);
+            }
+        }
+        // Whatever is left is no longer about to be connected. Blocks being
+        // loaded are discarded by their thread once it finds them gone.
+        m_entries = std::move(entries);
+        m_queue = std::move(queue);
+    }
+    m_cv.notify_all();
+}
+
+std::shared_ptr<const CBlock> BlockPrefetcher::Take(const uint256& hash)
+{
+    WAIT_LOCK(m_mutex, lock);
+    auto it{m_entries.find(hash)};
+    if (it == m_entries.end()) return nullptr;
+    if (it->second.loading) {
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+            it = m_entries.find(hash);
+            return it == m_entries.end() || !it->second.loading;
+        });
+        if (it == m_entries.end()) return nullptr;
+    }
+    if (!it->second.loaded) {
+        // Reading the block here is no slower than waiting for a thread to do it
+        m_queue.erase(std::find(m_queue.begin(), m_queue.end(), hash));
+    }
+    std::shared_ptr<const CBlock> block{std::move(it->second.block)};
+    m_entries.erase(it);
+    Refill();
+    return block;
+}
+
+void BlockPrefetcher::Refill()
+{
+    bool queued{false};
+    while (m_entries.size() < m_max_blocks && !m_pending.empty()) {
+        const auto [index, pos]{m_pending.front()};
+        m_pending.pop_front();
+        const uint256 hash{index->GetBlockHash()};
+        if (auto [it, inserted]{m_entries.try_emplace(hash)}; inserted) {
+            it->second.index = index;
+            it->second.pos = pos;
+            m_queue.push_back(hash);
+            queued = true;
+        }
+    }
+    if (queued) m_cv.notify_all();
+}
+
+size_t BlockPrefetcher::Size() const
+{
+    return WITH_LOCK(m_mutex, return m_entries.size());
+}
+
+void BlockPrefetcher::ThreadLoad()
+{
+    WAIT_LOCK(m_mutex, lock);
+    while (true) {
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return !m_queue.empty() || m_stop; });
+        if (m_stop) return;
+
+        const uint256 hash{m_queue.front()};
+        m_queue.pop_front();
+        Entry& entry{m_entries.at(hash)};
+        entry.loading = true;
+        const CBlockIndex& index{*entry.index};
+        const FlatFilePos pos{entry.pos};
+
+        std::shared_ptr<const CBlock> block;
+        {
+            REVERSE_LOCK(lock);
+            block = m_load(index, pos);
+        }
+        if (auto it{m_entries.find(hash)}; it != m_entries.end() && it->second.loading) {
+            it->second.loading = false;
+            it->second.loaded = true;
+            it->second.block = std::move(block);
+        }
+        m_cv.notify_all();
+        if (block) {
+            // Dropped while loading, free it outside the lock
+            REVERSE_LOCK(lock);
+            block.reset();
+        }
+    }
+}
+
+} // namespace node
@@ -0,0 +1,103 @@
+// Copyright (c) 2023 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OCVCOIN_NODE_BLOCK_PREFETCHER_H
+#define OCVCOIN_NODE_BLOCK_PREFETCHER_H
+
+#include <flatfile.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class CBlock;
+class CBlockIndex;
+
+namespace node {
+
+/** The maximum number of threads loading blocks ahead of the tip */
+static constexpr int MAX_BLOCK_PREFETCH_THREADS{2};
+
+/**
+ * Loads the blocks about to be connected on background threads, so that
+ * reading, deserializing and the context-free checks of CheckBlock (which
+ * include the merkle root) overlap with connecting the blocks before them.
+ *
+ * Blocks are handed over with Take() in the order they are connected. Only
+ * a limited number of blocks is held at any time; each Take() queues the
+ * next block of the list given to Prefetch(). Blocks which are no longer
+ * about to be connected (after a reorg, or an invalid block) are dropped
+ * with the next call to Prefetch().
+ */
+class BlockPrefetcher
+{
+public:
+    //! Reads and checks the block of the given index at the given position, or returns nullptr.
+    using LoadFn = std::function<std::shared_ptr<const CBlock>(const CBlockIndex&, const FlatFilePos&)>;
+
+    BlockPrefetcher(LoadFn load, int num_threads, size_t max_blocks);
+
+    /** Stops loading blocks, dropping the ones not taken. */
+    ~BlockPrefetcher();
+
+    BlockPrefetcher(const BlockPrefetcher&) = delete;
+    BlockPrefetcher& operator=(const BlockPrefetcher&) = delete;
+
+    /**
+     * Set the blocks about to be connected, in connection order, with their
+     * positions on disk. Blocks already queued or loaded are kept, others are
+     * dropped. The first max_blocks are queued, the rest as blocks are taken.
+     */
+    void Prefetch(const std::vector<std::pair<const CBlockIndex*, FlatFilePos>>& blocks) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Hand over a loaded block, waiting for it if it is being loaded.
+     * Returns nullptr if the block was not queued, loading has not started
+     * yet or it failed; the caller then reads the block itself.
+     */
+    std::shared_ptr<const CBlock> Take(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Number of blocks queued, being loaded or loaded, not counting the ones waiting for room. */
+    size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Entry {
+        const CBlockIndex* index;
+        FlatFilePos pos;
+        bool loading{false};
+        bool loaded{false};
+        std::shared_ptr<const CBlock> block;
+    };
+
+    const LoadFn m_load;
+    const size_t m_max_blocks;
+
+    mutable Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::map<uint256, Entry> m_entries GUARDED_BY(m_mutex);
+    //! Hashes of the entries not picked up by a thread yet, in connection order.
+    std::deque<uint256> m_queue GUARDED_BY(m_mutex);
+    //! Blocks to queue once there is room for them, in connection order.
+    std::deque<std::pair<const CBlockIndex*, FlatFilePos>> m_pending GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+
+    std::vector<std::thread> m_threads;
+
+    //! Queue pending blocks until max_blocks are held.
+    void Refill() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    void ThreadLoad() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+
+} // namespace node
+
+#endif // OCVCOIN_NODE_BLOCK_PREFETCHER_H
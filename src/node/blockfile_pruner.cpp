@@ -0,0 +1,75 @@
+// Copyright (c) 2023 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockfile_pruner.h>
+
+#include <logging.h>
+#include <sync.h>
+#include <util/thread.h>
+
+namespace node {
+
+BlockFilePruner::BlockFilePruner(UnlinkFn unlink, std::chrono::milliseconds interval)
+    : m_unlink{std::move(unlink)},
+      m_interval{interval}
+{
+    m_thread = std::thread(&util::TraceThread, "pruner", [this] { ThreadPrune(); });
+}
+
+BlockFilePruner::~BlockFilePruner()
+{
+    WITH_LOCK(m_mutex, m_stop = true);
+    m_cv.notify_all();
+    m_thread.join();
+}
+
+void BlockFilePruner::Enqueue(const std::set<int>& file_nums)
+{
+    {
+        LOCK(m_mutex);
+        m_queue.insert(m_queue.end(), file_nums.begin(), file_nums.end());
+        LogPrint(BCLog::PRUNE, "Queued %u block files for deletion, %u pending\n", file_nums.size(), m_queue.size());
+    }
+    m_cv.notify_all();
+}
+
+size_t BlockFilePruner::Pending() const
+{
+    return WITH_LOCK(m_mutex, return m_queue.size());
+}
+
+void BlockFilePruner::WaitForAll()
+{
+    WAIT_LOCK(m_mutex, lock);
+    m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_queue.empty() || m_stop; });
+}
+
+void BlockFilePruner::ThreadPrune()
+{
+    WAIT_LOCK(m_mutex, lock);
+    while (true) {
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return !m_queue.empty() || m_stop; });
+        if (m_stop) {
+            if (!m_queue.empty()) {
+                LogPrint(BCLog::PRUNE, "Leaving %u pruned block files to be deleted at startup\n", m_queue.size());
+            }
+            return;
+        }
+
+        const int file_num{m_queue.front()};
+        {
+            REVERSE_LOCK(lock);
+            m_unlink(file_num);
+        }
+        m_queue.pop_front();
+        m_cv.notify_all();
+        if (m_queue.empty()) continue;
+
+        LogPrint(BCLog::PRUNE, "%u pruned block files left to delete\n", m_queue.size());
+        // Leave the disk to others for a moment
+        m_cv.wait_for(lock, m_interval, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop; });
+    }
+}
+
+} // namespace node
@@ -0,0 +1,69 @@
+// Copyright (c) 2023 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OCVCOIN_NODE_BLOCKFILE_PRUNER_H
+#define OCVCOIN_NODE_BLOCKFILE_PRUNER_H
+
+#include <sync.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <set>
+#include <thread>
+
+namespace node {
+
+/**
+ * Deletes pruned block and undo files on a background thread, one file
+ * number at a time with a pause in between, so that deleting many files on a
+ * slow filesystem does not hold up validation or starve other disk I/O.
+ *
+ * Files are only queued once the block index records them as pruned, so
+ * files left over at shutdown are deleted on the next startup by
+ * BlockManager::ScanAndUnlinkAlreadyPrunedFiles.
+ */
+class BlockFilePruner
+{
+public:
+    //! Deletes the block and undo files with the given number.
+    using UnlinkFn = std::function<void(int)>;
+
+    BlockFilePruner(UnlinkFn unlink, std::chrono::milliseconds interval);
+
+    /** Stops deleting files, leaving the rest to the next startup. */
+    ~BlockFilePruner();
+
+    BlockFilePruner(const BlockFilePruner&) = delete;
+    BlockFilePruner& operator=(const BlockFilePruner&) = delete;
+
+    /** Queue file numbers for deletion. */
+    void Enqueue(const std::set<int>& file_nums) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Number of file numbers queued that have not been deleted yet. */
+    size_t Pending() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Wait until all queued files are deleted. */
+    void WaitForAll() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    const UnlinkFn m_unlink;
+    const std::chrono::milliseconds m_interval;
+
+    mutable Mutex m_mutex;
+    std::condition_variable m_cv;
+    //! Queued file numbers, including the one being deleted at the front.
+    std::deque<int> m_queue GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+
+    std::thread m_thread;
+
+    void ThreadPrune() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+
+} // namespace node
+
+#endif // OCVCOIN_NODE_BLOCKFILE_PRUNER_H
@@ -0,0 +1,95 @@
+// Copyright (c) 2023 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockfile_writer.h>
+
+#include <logging.h>
+#include <sync.h>
+#include <util/thread.h>
+
+#include <exception>
+
+namespace node {
+
+BlockFileWriter::BlockFileWriter(size_t max_pending_bytes, std::function<void()> on_error)
+    : m_max_pending_bytes{max_pending_bytes},
+      m_on_error{std::move(on_error)}
+{
+    m_thread = std::thread(&util::TraceThread, "blkwriter", [this] { ThreadWrite(); });
+}
+
+BlockFileWriter::~BlockFileWriter()
+{
+    WITH_LOCK(m_mutex, m_stop = true);
+    m_cv.notify_all();
+    m_thread.join();
+}
+
+void BlockFileWriter::Enqueue(Job job, size_t bytes, std::optional<FileKey> file)
+{
+    {
+        WAIT_LOCK(m_mutex, lock);
+        // Always admit a job into an empty queue, however large it is.
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+            return m_queue.empty() || m_pending_bytes + bytes <= m_max_pending_bytes;
+        });
+        m_pending_bytes += bytes;
+        if (file) ++m_pending_files[*file];
+        m_queue.push_back({std::move(job), bytes, std::move(file)});
+    }
+    m_cv.notify_all();
+}
+
+void BlockFileWriter::WaitForFile(const FileKey& file)
+{
+    WAIT_LOCK(m_mutex, lock);
+    m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_pending_files.count(file) == 0; });
+}
+
+void BlockFileWriter::WaitForAll()
+{
+    WAIT_LOCK(m_mutex, lock);
+    m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_queue.empty(); });
+}
+
+void BlockFileWriter::ThreadWrite()
+{
+    while (true) {
+        Job job;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return !m_queue.empty() || m_stop; });
+            // Only stop once everything queued has been written.
+            if (m_queue.empty()) return;
+            // The entry stays queued until the job is done, for WaitForFile
+            job = std::move(m_queue.front().job);
+        }
+
+        bool success;
+        try {
+            success = job();
+        } catch (const std::exception& e) {
+            LogPrintf("%s: %s\n", __func__, e.what());
+            success = false;
+        }
+        if (!success) {
+            m_failed = true;
+            m_on_error();
+        }
+
+        {
+            LOCK(m_mutex);
+            const QueuedJob& done{m_queue.front()};
+            m_pending_bytes -= done.bytes;
+            if (done.file) {
+                auto it{m_pending_files.find(*done.file)};
+                if (--it->second == 0) m_pending_files.erase(it);
+            }
+            m_queue.pop_front();
+        }
+        m_cv.notify_all();
+    }
+}
+
+} // namespace node
@@ -0,0 +1,91 @@
+// Copyright (c) 2023 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OCVCOIN_NODE_BLOCKFILE_WRITER_H
+#define OCVCOIN_NODE_BLOCKFILE_WRITER_H
+
+#include <sync.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace node {
+
+/**
+ * Runs block and undo file I/O on a background thread, in the order it was
+ * queued, so that validation does not wait for the disk. Callers allocate
+ * file positions before queueing a write, and wait for the writes to a file
+ * before reading from it.
+ */
+class BlockFileWriter
+{
+public:
+    //! Performs the I/O. Returns false on a write failure.
+    using Job = std::function<bool()>;
+    //! A flat file that a job writes to: whether it is an undo file, and its number.
+    using FileKey = std::pair<bool, int>;
+
+    /**
+     * @param[in] max_pending_bytes  Enqueue blocks while more than this many bytes are queued.
+     * @param[in] on_error           Called on the writer thread when a job fails.
+     */
+    BlockFileWriter(size_t max_pending_bytes, std::function<void()> on_error);
+
+    /** Waits for all queued jobs to finish. */
+    ~BlockFileWriter();
+
+    BlockFileWriter(const BlockFileWriter&) = delete;
+    BlockFileWriter& operator=(const BlockFileWriter&) = delete;
+
+    /** Queue a job writing bytes bytes to file. */
+    void Enqueue(Job job, size_t bytes = 0, std::optional<FileKey> file = std::nullopt) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Wait until the jobs queued so far that write to file are done. */
+    void WaitForFile(const FileKey& file) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Wait until all jobs queued so far are done. */
+    void WaitForAll() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Whether any job has failed. Stays set, as the data of a failed write
+     * is lost even if later writes succeed.
+     */
+    bool Failed() const { return m_failed.load(); }
+
+private:
+    struct QueuedJob {
+        Job job;
+        size_t bytes;
+        std::optional<FileKey> file;
+    };
+
+    const size_t m_max_pending_bytes;
+    const std::function<void()> m_on_error;
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    //! Queued jobs, including the one being run at the front.
+    std::deque<QueuedJob> m_queue GUARDED_BY(m_mutex);
+    size_t m_pending_bytes GUARDED_BY(m_mutex){0};
+    //! Number of queued jobs per file written to.
+    std::map<FileKey, size_t> m_pending_files GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::atomic<bool> m_failed{false};
+
+    std::thread m_thread;
+
+    void ThreadWrite() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+
+} // namespace node
+
+#endif // OCVCOIN_NODE_BLOCKFILE_WRITER_H
@@ -11,7 +11,9 @@
 #include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <limits>
 
 namespace node {
 util::Result<void> ApplyArgsManOptions(const ArgsManager& args, BlockManager::Options& opts)
@@ -33,6 +35,26 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& args, BlockManager::Op
 
     if (auto value{args.GetBoolArg("-fastprune")}) opts.fast_prune = *value;
 
+    if (auto value{args.GetBoolArg("-blockcompression")}) opts.block_compression = *value;
+
+    if (auto value{args.GetBoolArg("-asyncblockwrites")}) opts.async_writes = *value;
+
+    if (auto value{args.GetBoolArg("-backgroundprune")}) opts.background_prune = *value;
+
+    if (auto value{args.GetIntArg("-blockfilemaps")}) {
+        if (*value < 0) {
+            return util::Error{_("-blockfilemaps cannot be configured with a negative value.")};
+        }
+        opts.blockfile_maps = *value;
+    }
+
+    if (auto value{args.GetIntArg("-undocache")}) {
+        if (*value < 0) {
+            return util::Error{_("-undocache cannot be configured with a negative value.")};
+        }
+        opts.undo_cache_bytes = static_cast<size_t>(std::min<int64_t>(*value, std::numeric_limits<size_t>::max() >> 20)) << 20;
+    }
+
     return {};
 }
 } // namespace node
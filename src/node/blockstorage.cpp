@@ -6,6 +6,8 @@
 
 #include <chain.h>
 #include <clientversion.h>
+#include <compressor.h>
+#include <consensus/amount.h>
 #include <consensus/validation.h>
 #include <dbwrapper.h>
 #include <flatfile.h>
@@ -22,12 +24,18 @@
 #include <undo.h>
 #include <util/batchpriority.h>
 #include <util/fs.h>
+#include <util/fs_helpers.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
+#include <util/thread.h>
 #include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <map>
+#include <thread>
 #include <unordered_map>
 
 namespace kernel {
@@ -46,6 +54,11 @@ bool BlockTreeDB::ReadBlockFileInfo(int nFile, CBlockFileInfo& info)
     return Read(std::make_pair(DB_BLOCK_FILES, nFile), info);
 }
 
+bool BlockTreeDB::EraseBlockFileInfo(int nFile)
+{
+    return Erase(std::make_pair(DB_BLOCK_FILES, nFile), /*fSync=*/true);
+}
+
 bool BlockTreeDB::WriteReindexing(bool fReindexing)
 {
     if (fReindexing) {
@@ -502,6 +515,10 @@ bool BlockManager::LoadBlockIndexDB(const std::optional<uint256>& snapshot_block
             break;
         }
     }
+    // Drop trailing entries of files that were renumbered by -defragblocks
+    while (m_blockfile_info.size() > 1 && m_blockfile_info.back().nBlocks == 0 && m_blockfile_info.back().nSize == 0) {
+        m_blockfile_info.pop_back();
+    }
 
     // Check presence of blk files
     LogPrintf("Checking all blk files are present...\n");
@@ -655,6 +672,27 @@ CBlockFileInfo* BlockManager::GetBlockFileInfo(size_t n)
 
 bool BlockManager::UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const uint256& hashBlock) const
 {
+    if (m_block_writer) {
+        // Serialize the whole record now, and leave the file I/O to the writer thread
+        HashWriter hasher{};
+        hasher << hashBlock;
+        hasher << blockundo;
+        std::vector<unsigned char> record;
+        CVectorWriter{CLIENT_VERSION, record, 0, GetParams().MessageStart(), static_cast<unsigned int>(GetSerializeSize(blockundo, CLIENT_VERSION)), blockundo, hasher.GetHash()};
+        const FlatFilePos record_pos{pos};
+        pos.nPos += BLOCK_SERIALIZATION_HEADER_SIZE;
+        const size_t record_size{record.size()};
+        m_block_writer->Enqueue([this, record_pos, record = std::move(record)] {
+            CAutoFile fileout{OpenUndoFile(record_pos)};
+            if (fileout.IsNull()) {
+                return error("UndoWriteToDisk: OpenUndoFile failed");
+            }
+            fileout.write(MakeByteSpan(record));
+            return true;
+        }, record_size, BlockFileWriter::FileKey{true, pos.nFile});
+        return true;
+    }
+
     // Open history file to append
     CAutoFile fileout{OpenUndoFile(pos)};
     if (fileout.IsNull()) {
@@ -690,6 +728,75 @@ bool BlockManager::UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex& in
         return error("%s: no undo data available", __func__);
     }
 
+    if (const auto cached{m_undo_cache.Get(index.GetBlockHash())}) {
+        blockundo = *cached;
+        return true;
+    }
+    if (!ReadUndoRecord(blockundo, pos, index.pprev->GetBlockHash())) {
+        return false;
+    }
+    if (m_undo_cache.IsEnabled()) {
+        m_undo_cache.Insert(index.GetBlockHash(), std::make_shared<const CBlockUndo>(blockundo));
+    }
+    return true;
+}
+
+void BlockManager::PrefetchUndo(const std::vector<const CBlockIndex*>& blocks) const
+{
+    AssertLockNotHeld(::cs_main);
+    if (!m_undo_cache.IsEnabled()) return;
+
+    struct UndoRead {
+        uint256 block_hash;
+        FlatFilePos pos;
+        uint256 prev_hash;
+        std::shared_ptr<CBlockUndo> undo;
+    };
+    std::vector<UndoRead> reads;
+    {
+        LOCK(::cs_main);
+        for (const CBlockIndex* pindex : blocks) {
+            if (!pindex->pprev || !(pindex->nStatus & BLOCK_HAVE_UNDO)) continue;
+            if (m_undo_cache.Contains(pindex->GetBlockHash())) continue;
+            reads.push_back({pindex->GetBlockHash(), pindex->GetUndoPos(), pindex->pprev->GetBlockHash(), nullptr});
+        }
+    }
+    // A single read is done just as well by UndoReadFromDisk
+    if (reads.size() < 2) return;
+
+    // Stop once the cache is full, as more undo data would only evict the
+    // undo data needed first.
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> usage{0};
+    std::atomic<size_t> num_read{0};
+    const auto read_undo{[&] {
+        for (size_t i{next++}; i < reads.size() && usage < m_undo_cache.MaxUsage(); i = next++) {
+            auto undo{std::make_shared<CBlockUndo>()};
+            if (ReadUndoRecord(*undo, reads[i].pos, reads[i].prev_hash)) {
+                usage += BlockUndoUsage(*undo);
+                ++num_read;
+                reads[i].undo = std::move(undo);
+            }
+        }
+    }};
+    std::vector<std::thread> threads;
+    for (size_t n{1}; n < std::min(reads.size(), MAX_UNDO_PREFETCH_THREADS); ++n) {
+        threads.emplace_back(read_undo);
+    }
+    read_undo();
+    for (std::thread& thread : threads) thread.join();
+
+    // Insert the undo data read first last, so that it is evicted last
+    for (auto it{reads.rbegin()}; it != reads.rend(); ++it) {
+        if (it->undo) m_undo_cache.Insert(it->block_hash, std::move(it->undo));
+    }
+    LogPrint(BCLog::BLOCKSTORAGE, "Prefetched undo data of %u of %u blocks, undo cache usage %u bytes\n", num_read.load(), reads.size(), m_undo_cache.Usage());
+}
+
+bool BlockManager::ReadUndoRecord(CBlockUndo& blockundo, const FlatFilePos& pos, const uint256& prev_hash) const
+{
+    WaitForFileWrites(/*undo=*/true, pos.nFile);
+
     // Open history file to read
     CAutoFile filein{OpenUndoFile(pos, true)};
     if (filein.IsNull()) {
@@ -700,7 +807,7 @@ bool BlockManager::UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex& in
     uint256 hashChecksum;
     HashVerifier verifier{filein}; // Use HashVerifier as reserializing may lose data, c.f. commit d342424301013ec47dc146a4beb49d5c9319d80a
     try {
-        verifier << index.pprev->GetBlockHash();
+        verifier << prev_hash;
         verifier >> blockundo;
         filein >> hashChecksum;
     } catch (const std::exception& e) {
@@ -718,16 +825,38 @@ bool BlockManager::UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex& in
 bool BlockManager::FlushUndoFile(int block_file, bool finalize)
 {
     FlatFilePos undo_pos_old(block_file, m_blockfile_info[block_file].nUndoSize);
-    if (!UndoFileSeq().Flush(undo_pos_old, finalize)) {
+    if (m_block_writer) {
+        if (finalize) {
+            // Finalize after the writes queued so far. A failed flush is only
+            // reported, as in the synchronous case, so the job always succeeds.
+            m_block_writer->Enqueue([this, undo_pos_old] {
+                FlushFiles(std::nullopt, false, undo_pos_old, true);
+                return true;
+            });
+            return !m_block_writer->Failed();
+        }
+        m_block_writer->WaitForAll();
+        if (m_block_writer->Failed()) return false;
+    }
+    return FlushFiles(std::nullopt, false, undo_pos_old, finalize);
+}
+
+bool BlockManager::FlushFiles(std::optional<FlatFilePos> block_pos, bool finalize, std::optional<FlatFilePos> undo_pos, bool finalize_undo) const
+{
+    bool success = true;
+    if (block_pos && !BlockFileSeq().Flush(*block_pos, finalize)) {
+        m_opts.notifications.flushError("Flushing block file to disk failed. This is likely the result of an I/O error.");
+        success = false;
+    }
+    if (undo_pos && !UndoFileSeq().Flush(*undo_pos, finalize_undo)) {
         m_opts.notifications.flushError("Flushing undo file to disk failed. This is likely the result of an I/O error.");
-        return false;
+        success = false;
     }
-    return true;
+    return success;
 }
 
 bool BlockManager::FlushBlockFile(int blockfile_num, bool fFinalize, bool finalize_undo)
 {
-    bool success = true;
     LOCK(cs_LastBlockFile);
 
     if (m_blockfile_info.size() < 1) {
@@ -740,18 +869,28 @@ bool BlockManager::FlushBlockFile(int blockfile_num, bool fFinalize, bool finali
     assert(static_cast<int>(m_blockfile_info.size()) > blockfile_num);
 
     FlatFilePos block_pos_old(blockfile_num, m_blockfile_info[blockfile_num].nSize);
-    if (!BlockFileSeq().Flush(block_pos_old, fFinalize)) {
-        m_opts.notifications.flushError("Flushing block file to disk failed. This is likely the result of an I/O error.");
-        success = false;
-    }
     // we do not always flush the undo file, as the chain tip may be lagging behind the incoming blocks,
     // e.g. during IBD or a sync after a node going offline
+    std::optional<FlatFilePos> undo_pos_old;
     if (!fFinalize || finalize_undo) {
-        if (!FlushUndoFile(blockfile_num, finalize_undo)) {
-            success = false;
+        undo_pos_old = FlatFilePos(blockfile_num, m_blockfile_info[blockfile_num].nUndoSize);
+    }
+
+    if (m_block_writer) {
+        if (fFinalize) {
+            // Moving on to a new block file does not need to wait for the old one
+            m_block_writer->Enqueue([this, block_pos_old, undo_pos_old, finalize_undo] {
+                FlushFiles(block_pos_old, true, undo_pos_old, finalize_undo);
+                return true;
+            });
+            return !m_block_writer->Failed();
         }
+        // Callers rely on everything written so far being on disk once this
+        // returns, so a failed write must keep them from committing the index.
+        m_block_writer->WaitForAll();
+        if (m_block_writer->Failed()) return false;
     }
-    return success;
+    return FlushFiles(block_pos_old, fFinalize, undo_pos_old, finalize_undo);
 }
 
 BlockfileType BlockManager::BlockfileTypeForHeight(int height)
@@ -789,15 +928,196 @@ uint64_t BlockManager::CalculateCurrentUsage()
 
 void BlockManager::UnlinkPrunedFiles(const std::set<int>& setFilesToPrune) const
 {
-    std::error_code ec;
+    // Pending writes or flushes may still refer to the files
+    if (m_block_writer) m_block_writer->WaitForAll();
+    if (m_pruner) {
+        m_pruner->Enqueue(setFilesToPrune);
+        return;
+    }
     for (std::set<int>::iterator it = setFilesToPrune.begin(); it != setFilesToPrune.end(); ++it) {
-        FlatFilePos pos(*it, 0);
-        const bool removed_blockfile{fs::remove(BlockFileSeq().FileName(pos), ec)};
-        const bool removed_undofile{fs::remove(UndoFileSeq().FileName(pos), ec)};
-        if (removed_blockfile || removed_undofile) {
-            LogPrint(BCLog::BLOCKSTORAGE, "Prune: %s deleted blk/rev (%05u)\n", __func__, *it);
+        UnlinkPrunedFile(*it);
+    }
+}
+
+void BlockManager::UnlinkPrunedFile(int file_num) const
+{
+    std::error_code ec;
+    FlatFilePos pos(file_num, 0);
+    m_mapped_block_files.Erase(file_num);
+    const bool removed_blockfile{fs::remove(BlockFileSeq().FileName(pos), ec)};
+    const bool removed_undofile{fs::remove(UndoFileSeq().FileName(pos), ec)};
+    if (removed_blockfile || removed_undofile) {
+        LogPrint(BCLog::BLOCKSTORAGE, "Prune: %s deleted blk/rev (%05u)\n", __func__, file_num);
+    }
+}
+
+std::optional<DefragRange> BlockManager::StartDefrag(const CChain& chain)
+{
+    AssertLockHeld(::cs_main);
+    bool defragmented{false};
+    if (m_block_tree_db->ReadFlag("defragmented", defragmented) && defragmented) {
+        LogPrintf("Block files were defragmented before, skipping -defragblocks\n");
+        return std::nullopt;
+    }
+
+    LOCK(cs_LastBlockFile);
+    auto& cursor{m_blockfile_cursors[BlockfileType::NORMAL]};
+    if (IsPruneMode() || m_snapshot_height || !cursor || m_blockfile_info.empty()) {
+        LogPrintf("Block files can not be defragmented in this mode, skipping\n");
+        return std::nullopt;
+    }
+    const int first_new{MaxBlockfileNum() + 1};
+
+    // Keep the files that hold the first blocks of the chain in order, and
+    // nothing else.
+    int first_moved{0};
+    unsigned int blocks_in_file{0};
+    for (const CBlockIndex* pindex{chain.Genesis()}; pindex && (pindex->nStatus & BLOCK_HAVE_DATA); pindex = chain.Next(pindex)) {
+        if (pindex->nFile == first_moved + 1 && blocks_in_file == m_blockfile_info[first_moved].nBlocks) {
+            ++first_moved;
+            blocks_in_file = 0;
+        }
+        if (pindex->nFile != first_moved || (blocks_in_file > 0 && pindex->nDataPos <= pindex->pprev->nDataPos)) break;
+        ++blocks_in_file;
+    }
+    if (blocks_in_file > 0 && blocks_in_file == m_blockfile_info[first_moved].nBlocks) ++first_moved;
+    if (first_moved >= first_new) {
+        LogPrintf("Block files are in chain order already, skipping -defragblocks\n");
+        return std::nullopt;
+    }
+
+    // The rewritten files are deleted once all their blocks are copied.
+    uint64_t copy_size{0};
+    for (int file_num{first_moved}; file_num < first_new; ++file_num) {
+        copy_size += m_blockfile_info[file_num].nSize + m_blockfile_info[file_num].nUndoSize;
+    }
+    if (!CheckDiskSpace(m_opts.blocks_dir, copy_size)) {
+        LogPrintf("Not enough disk space to defragment block files, %d MiB are needed, skipping\n", copy_size >> 20);
+        return std::nullopt;
+    }
+
+    // Finish the current file as on a regular move to a new one. Undo data of
+    // blocks stored there that are not connected yet may still be appended.
+    if (!FlushBlockFile(cursor->file_num, /*fFinalize=*/true, /*finalize_undo=*/true)) {
+        LogPrintLevel(BCLog::BLOCKSTORAGE, BCLog::Level::Warning, "Failed to flush block file %05i\n", cursor->file_num);
+    }
+    cursor = BlockfileCursor{first_new};
+    return DefragRange{first_moved, first_new};
+}
+
+bool BlockManager::MoveBlockData(CBlockIndex& index, const DefragRange& range)
+{
+    AssertLockHeld(::cs_main);
+    if (!(index.nStatus & BLOCK_HAVE_DATA) || index.nFile < range.first_moved || index.nFile >= range.first_new) return true;
+
+    CBlock block;
+    if (!ReadBlockFromDisk(block, index)) return false;
+    CBlockUndo blockundo;
+    const bool have_undo{(index.nStatus & BLOCK_HAVE_UNDO) != 0};
+    if (have_undo && !UndoReadFromDisk(blockundo, index)) return false;
+
+    const FlatFilePos block_pos{SaveBlockToDisk(block, index.nHeight, /*dbp=*/nullptr)};
+    if (block_pos.IsNull()) return false;
+    FlatFilePos undo_pos;
+    if (have_undo) {
+        BlockValidationState state;
+        if (!FindUndoPos(state, block_pos.nFile, undo_pos, ::GetSerializeSize(blockundo, CLIENT_VERSION) + 40) ||
+            !UndoWriteToDisk(blockundo, undo_pos, index.pprev->GetBlockHash())) {
+            return error("%s: Failed to write undo data of %s", __func__, index.GetBlockHash().ToString());
+        }
+    }
+
+    index.nFile = block_pos.nFile;
+    index.nDataPos = block_pos.nPos;
+    index.nUndoPos = have_undo ? undo_pos.nPos : 0;
+    m_dirty_blockindex.insert(&index);
+    return true;
+}
+
+bool BlockManager::FinishDefrag(const DefragRange& range)
+{
+    {
+        LOCK(::cs_main);
+        for (const auto& [_, index] : m_block_index) {
+            if ((index.nStatus & (BLOCK_HAVE_DATA | BLOCK_HAVE_UNDO)) && index.nFile >= range.first_moved && index.nFile < range.first_new) {
+                return error("%s: Block %s is still stored in block file %05i", __func__, index.GetBlockHash().ToString(), index.nFile);
+            }
+        }
+        if (m_block_writer) m_block_writer->WaitForAll();
+        LOCK(cs_LastBlockFile);
+        for (int file_num{range.first_moved}; file_num < range.first_new; ++file_num) {
+            UnlinkPrunedFile(file_num);
+            m_blockfile_info[file_num] = CBlockFileInfo{};
+            m_dirty_fileinfo.insert(file_num);
+        }
+        if (!WriteBlockIndexDB()) return false;
+    }
+
+    // Move the remaining files down one at a time, so other threads can take
+    // cs_main in between.
+    for (int from{range.first_new}; true; ++from) {
+        LOCK(::cs_main);
+        if (from > WITH_LOCK(cs_LastBlockFile, return MaxBlockfileNum())) break;
+        if (!RenumberBlockFile(from, range.first_moved + from - range.first_new)) return false;
+    }
+
+    LOCK2(::cs_main, cs_LastBlockFile);
+    const int num_files{MaxBlockfileNum() + 1};
+    for (int file_num{num_files}; file_num < static_cast<int>(m_blockfile_info.size()); ++file_num) {
+        m_dirty_fileinfo.erase(file_num);
+        m_block_tree_db->EraseBlockFileInfo(file_num);
+    }
+    m_blockfile_info.resize(num_files);
+    LogPrintf("Defragmented block files, now blk00000.dat to blk%05u.dat\n", num_files - 1);
+    return WriteBlockIndexDB() && m_block_tree_db->WriteFlag("defragmented", true);
+}
+
+bool BlockManager::RenumberBlockFile(int from, int to)
+{
+    AssertLockHeld(::cs_main);
+    if (m_block_writer) m_block_writer->WaitForAll();
+    LOCK(cs_LastBlockFile);
+
+    // Link the files under their new number first, so that both numbers can
+    // be read until the block index refers to the new one.
+    const FlatFilePos from_pos(from, 0);
+    const FlatFilePos to_pos(to, 0);
+    for (const FlatFileSeq& seq : {BlockFileSeq(), UndoFileSeq()}) {
+        const fs::path from_path{seq.FileName(from_pos)};
+        if (!fs::exists(from_path)) continue;
+        std::error_code ec;
+        fs::create_hard_link(from_path, seq.FileName(to_pos), ec);
+        if (!ec) continue;
+        try {
+            fs::copy_file(from_path, seq.FileName(to_pos), fs::copy_options::overwrite_existing);
+        } catch (const fs::filesystem_error& e) {
+            return error("%s: Failed to copy %s: %s", __func__, fs::PathToString(from_path), fsbridge::get_filesystem_error_message(e));
         }
     }
+
+    for (auto& [_, index] : m_block_index) {
+        if ((index.nStatus & (BLOCK_HAVE_DATA | BLOCK_HAVE_UNDO)) && index.nFile == from) {
+            index.nFile = to;
+            m_dirty_blockindex.insert(&index);
+        }
+    }
+    m_blockfile_info[to] = m_blockfile_info[from];
+    m_blockfile_info[from] = CBlockFileInfo{};
+    m_dirty_fileinfo.insert(from);
+    m_dirty_fileinfo.insert(to);
+    for (auto& cursor : m_blockfile_cursors) {
+        if (cursor && cursor->file_num == from) cursor->file_num = to;
+    }
+    if (!WriteBlockIndexDB()) return false;
+
+    UnlinkPrunedFile(from);
+    m_mapped_block_files.Erase(to);
+    return true;
+}
+
+std::unique_ptr<BlockFilePruner> BlockManager::MakeBlockFilePruner() const
+{
+    return std::make_unique<BlockFilePruner>([this](int file_num) { UnlinkPrunedFile(file_num); }, BACKGROUND_PRUNE_INTERVAL);
 }
 
 FlatFileSeq BlockManager::BlockFileSeq() const
@@ -947,8 +1267,55 @@ bool BlockManager::FindUndoPos(BlockValidationState& state, int nFile, FlatFileP
     return true;
 }
 
-bool BlockManager::WriteBlockToDisk(const CBlock& block, FlatFilePos& pos) const
+/** Whether BlockCompression reproduces the block exactly, see TxCompression. */
+static bool IsBlockCompressible(const CBlock& block)
+{
+    for (const auto& tx : block.vtx) {
+        for (const CTxOut& txout : tx->vout) {
+            if (!MoneyRange(txout.nValue) || txout.scriptPubKey.size() > MAX_SCRIPT_SIZE) return false;
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<BlockFileWriter> BlockManager::MakeBlockFileWriter()
+{
+    return std::make_unique<BlockFileWriter>(MAX_PENDING_BLOCK_WRITE_BYTES, [this] {
+        m_opts.notifications.fatalError("Failed to write block data to disk");
+    });
+}
+
+void BlockManager::WaitForFileWrites(bool undo, int file_num) const
 {
+    if (m_block_writer) m_block_writer->WaitForFile({undo, file_num});
+}
+
+bool BlockManager::WriteBlockToDisk(const CBlock& block, FlatFilePos& pos, Span<const std::byte> compressed) const
+{
+    if (m_block_writer) {
+        // Serialize the whole record now, and leave the file I/O to the writer thread
+        std::vector<unsigned char> record;
+        CVectorWriter writer{CLIENT_VERSION, record, 0};
+        if (compressed.empty()) {
+            writer << GetParams().MessageStart() << static_cast<unsigned int>(GetSerializeSize(block, CLIENT_VERSION)) << block;
+        } else {
+            writer << GetParams().MessageStart() << (static_cast<unsigned int>(compressed.size()) | BLOCK_COMPRESSED_FLAG);
+            writer.write(compressed);
+        }
+        const FlatFilePos record_pos{pos};
+        pos.nPos += BLOCK_SERIALIZATION_HEADER_SIZE;
+        const size_t record_size{record.size()};
+        m_block_writer->Enqueue([this, record_pos, record = std::move(record)] {
+            CAutoFile fileout{OpenBlockFile(record_pos)};
+            if (fileout.IsNull()) {
+                return error("WriteBlockToDisk: OpenBlockFile failed");
+            }
+            fileout.write(MakeByteSpan(record));
+            return true;
+        }, record_size, BlockFileWriter::FileKey{false, pos.nFile});
+        return true;
+    }
+
     // Open history file to append
     CAutoFile fileout{OpenBlockFile(pos)};
     if (fileout.IsNull()) {
@@ -956,7 +1323,7 @@ bool BlockManager::WriteBlockToDisk(const CBlock& block, FlatFilePos& pos) const
     }
 
     // Write index header
-    unsigned int nSize = GetSerializeSize(block, fileout.GetVersion());
+    unsigned int nSize = compressed.empty() ? GetSerializeSize(block, fileout.GetVersion()) : (static_cast<unsigned int>(compressed.size()) | BLOCK_COMPRESSED_FLAG);
     fileout << GetParams().MessageStart() << nSize;
 
     // Write block
@@ -965,7 +1332,11 @@ bool BlockManager::WriteBlockToDisk(const CBlock& block, FlatFilePos& pos) const
         return error("WriteBlockToDisk: ftell failed");
     }
     pos.nPos = (unsigned int)fileOutPos;
-    fileout << block;
+    if (compressed.empty()) {
+        fileout << block;
+    } else {
+        fileout.write(compressed);
+    }
 
     return true;
 }
@@ -1011,21 +1382,58 @@ bool BlockManager::WriteUndoDataForBlock(const CBlockUndo& blockundo, BlockValid
     return true;
 }
 
-bool BlockManager::ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos) const
+bool BlockManager::ReadBlockRecord(CBlock& block, const FlatFilePos& pos) const
 {
     block.SetNull();
+    WaitForFileWrites(/*undo=*/false, pos.nFile);
+
+    bool compressed{false};
+    if (const auto view{MapBlockRecord(pos, compressed)}) {
+        // Deserialize straight from the mapped file
+        try {
+            SpanReader reader{CLIENT_VERSION, UCharSpanCast(view->data)};
+            if (compressed) {
+                reader >> Using<BlockCompression>(block);
+            } else {
+                UnserializeBlock(reader, block);
+            }
+        } catch (const std::exception& e) {
+            return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+        }
+    } else {
+        // Open history file to read, at the record header if there is one
+        const bool has_header{pos.nPos >= BLOCK_SERIALIZATION_HEADER_SIZE};
+        FlatFilePos hpos{pos};
+        if (has_header) hpos.nPos -= BLOCK_SERIALIZATION_HEADER_SIZE;
+        CAutoFile filein{OpenBlockFile(hpos, true)};
+        if (filein.IsNull()) {
+            return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
+        }
 
-    // Open history file to read
-    CAutoFile filein{OpenBlockFile(pos, true)};
-    if (filein.IsNull()) {
-        return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
+        // Read block
+        try {
+            if (has_header) {
+                MessageStartChars blk_start;
+                unsigned int blk_size;
+                filein >> blk_start >> blk_size;
+                compressed = blk_start == GetParams().MessageStart() && (blk_size & BLOCK_COMPRESSED_FLAG) != 0;
+            }
+            if (compressed) {
+                filein >> Using<BlockCompression>(block);
+            } else {
+                UnserializeBlock(filein, block);
+            }
+        } catch (const std::exception& e) {
+            return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+        }
     }
+    return true;
+}
 
-    // Read block
-    try {
-        filein >> block;
-    } catch (const std::exception& e) {
-        return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+bool BlockManager::ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos) const
+{
+    if (!ReadBlockRecord(block, pos)) {
+        return false;
     }
 
     // Check the header
@@ -1055,8 +1463,47 @@ bool BlockManager::ReadBlockFromDisk(CBlock& block, const CBlockIndex& index) co
     return true;
 }
 
+bool BlockManager::ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const CBlockIndex& index) const
+{
+    if (!ReadBlockRecord(block, pos)) {
+        return false;
+    }
+
+    const CBlockHeader header{index.GetBlockHeader()};
+    if (block.nVersion != header.nVersion || block.hashPrevBlock != header.hashPrevBlock ||
+        block.hashMerkleRoot != header.hashMerkleRoot || block.nTime != header.nTime ||
+        block.nBits != header.nBits || block.nNonce != header.nNonce) {
+        return error("%s: header doesn't match index for %s at %s", __func__, index.ToString(), pos.ToString());
+    }
+
+    // Signet only: check block solution
+    if (GetConsensus().signet_blocks && !CheckSignetBlockSolution(block, GetConsensus())) {
+        return error("%s: Errors in block solution at %s", __func__, pos.ToString());
+    }
+    return true;
+}
+
 bool BlockManager::ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos) const
 {
+    WaitForFileWrites(/*undo=*/false, pos.nFile);
+    bool compressed{false};
+    if (const auto view{MapBlockRecord(pos, compressed)}) {
+        if (!compressed) {
+            const auto bytes{UCharSpanCast(view->data)};
+            block.assign(bytes.begin(), bytes.end());
+            return true;
+        }
+        try {
+            CBlock decoded;
+            SpanReader{CLIENT_VERSION, UCharSpanCast(view->data)} >> Using<BlockCompression>(decoded);
+            block.clear();
+            CVectorWriter{CLIENT_VERSION, block, 0, decoded};
+        } catch (const std::exception& e) {
+            return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+        }
+        return true;
+    }
+
     FlatFilePos hpos = pos;
     hpos.nPos -= 8; // Seek back 8 bytes for meta header
     CAutoFile filein{OpenBlockFile(hpos, true)};
@@ -1069,6 +1516,8 @@ bool BlockManager::ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatF
         unsigned int blk_size;
 
         filein >> blk_start >> blk_size;
+        compressed = (blk_size & BLOCK_COMPRESSED_FLAG) != 0;
+        blk_size &= ~BLOCK_COMPRESSED_FLAG;
 
         if (blk_start != GetParams().MessageStart()) {
             return error("%s: Block magic mismatch for %s: %s versus expected %s", __func__, pos.ToString(),
@@ -1083,6 +1532,14 @@ bool BlockManager::ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatF
 
         block.resize(blk_size); // Zeroing of memory is intentional here
         filein.read(MakeWritableByteSpan(block));
+
+        if (compressed) {
+            // Peers and callers expect the network serialization
+            CBlock decoded;
+            SpanReader{CLIENT_VERSION, block} >> Using<BlockCompression>(decoded);
+            block.clear();
+            CVectorWriter{CLIENT_VERSION, block, 0, decoded};
+        }
     } catch (const std::exception& e) {
         return error("%s: Read from block file failed: %s for %s", __func__, e.what(), pos.ToString());
     }
@@ -1090,11 +1547,74 @@ bool BlockManager::ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatF
     return true;
 }
 
+std::optional<RawBlockView> BlockManager::ReadRawBlockView(const FlatFilePos& pos) const
+{
+    WaitForFileWrites(/*undo=*/false, pos.nFile);
+    bool compressed{false};
+    auto view{MapBlockRecord(pos, compressed)};
+    // A compressed record is not in the network serialization
+    if (compressed) return std::nullopt;
+    return view;
+}
+
+bool BlockManager::IsCompressedBlockRecord(const FlatFilePos& pos) const
+{
+    if (pos.IsNull() || pos.nPos < BLOCK_SERIALIZATION_HEADER_SIZE) return false;
+    WaitForFileWrites(/*undo=*/false, pos.nFile);
+    FlatFilePos hpos{pos};
+    hpos.nPos -= BLOCK_SERIALIZATION_HEADER_SIZE;
+    CAutoFile filein{OpenBlockFile(hpos, true)};
+    if (filein.IsNull()) return false;
+    try {
+        MessageStartChars blk_start;
+        unsigned int blk_size;
+        filein >> blk_start >> blk_size;
+        return blk_start == GetParams().MessageStart() && (blk_size & BLOCK_COMPRESSED_FLAG) != 0;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+std::optional<RawBlockView> BlockManager::MapBlockRecord(const FlatFilePos& pos, bool& compressed) const
+{
+    if (pos.IsNull() || pos.nPos < BLOCK_SERIALIZATION_HEADER_SIZE) return std::nullopt;
+
+    const fs::path path{BlockFileSeq().FileName(pos)};
+    auto file{m_mapped_block_files.Get(pos.nFile, path, pos.nPos)};
+    if (!file) return std::nullopt;
+
+    MessageStartChars blk_start;
+    unsigned int blk_size;
+    SpanReader{CLIENT_VERSION, UCharSpanCast(file->Data().subspan(pos.nPos - BLOCK_SERIALIZATION_HEADER_SIZE, BLOCK_SERIALIZATION_HEADER_SIZE))} >> blk_start >> blk_size;
+    compressed = (blk_size & BLOCK_COMPRESSED_FLAG) != 0;
+    blk_size &= ~BLOCK_COMPRESSED_FLAG;
+    if (blk_start != GetParams().MessageStart() || blk_size > MAX_SIZE) return std::nullopt;
+
+    if (file->Data().size() - pos.nPos < blk_size) {
+        // The block was appended after the file was mapped
+        file = m_mapped_block_files.Get(pos.nFile, path, size_t{pos.nPos} + blk_size);
+        if (!file) return std::nullopt;
+    }
+    const auto data{file->Data().subspan(pos.nPos, blk_size)};
+    return RawBlockView{std::move(file), data};
+}
+
 FlatFilePos BlockManager::SaveBlockToDisk(const CBlock& block, int nHeight, const FlatFilePos* dbp)
 {
     unsigned int nBlockSize = ::GetSerializeSize(block, CLIENT_VERSION);
     FlatFilePos blockPos;
     const auto position_known {dbp != nullptr};
+    // A compressed record is only written when it is smaller than the plain one,
+    // so the plain size reserved for a known position always covers the record.
+    DataStream compressed{};
+    if (!position_known && m_opts.block_compression && IsBlockCompressible(block)) {
+        compressed << Using<BlockCompression>(block);
+        if (compressed.size() < nBlockSize) {
+            nBlockSize = compressed.size();
+        } else {
+            compressed.clear();
+        }
+    }
     if (position_known) {
         blockPos = *dbp;
     } else {
@@ -1108,7 +1628,7 @@ FlatFilePos BlockManager::SaveBlockToDisk(const CBlock& block, int nHeight, cons
         return FlatFilePos();
     }
     if (!position_known) {
-        if (!WriteBlockToDisk(block, blockPos)) {
+        if (!WriteBlockToDisk(block, blockPos, compressed)) {
             m_opts.notifications.fatalError("Failed to write block");
             return FlatFilePos();
         }
@@ -1133,6 +1653,94 @@ public:
     }
 };
 
+/**
+ * Reads and hashes the blocks in the blk?????.dat files for -reindex on
+ * other threads, a few files ahead of the file whose blocks are being
+ * processed. The decoded blocks of each scanned file are held in memory until
+ * they are processed, so the lookahead is kept to one file per thread.
+ */
+class BlockFileScanner
+{
+public:
+    BlockFileScanner(ChainstateManager& chainman, int num_threads)
+        : m_chainman{chainman},
+          m_lookahead{num_threads}
+    {
+        for (int n{0}; n < num_threads; ++n) {
+            m_threads.emplace_back(&util::TraceThread, strprintf("reindex.%i", n), [this] { ThreadScan(); });
+        }
+    }
+
+    ~BlockFileScanner()
+    {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_cv.notify_all();
+        for (std::thread& thread : m_threads) thread.join();
+    }
+
+    /** Wait for the records of block file file_num, or return nullopt if it does not exist. */
+    std::optional<std::vector<BlockFileRecord>> Get(int file_num) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_wanted = file_num;
+        m_cv.notify_all();
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return file_num >= m_end || m_scanned.count(file_num); });
+        if (file_num >= m_end) return std::nullopt;
+        return std::move(m_scanned.extract(file_num).mapped());
+    }
+
+private:
+    ChainstateManager& m_chainman;
+    const int m_lookahead;
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    //! Next file to scan
+    int m_next GUARDED_BY(m_mutex){0};
+    //! First file that does not exist
+    int m_end GUARDED_BY(m_mutex){std::numeric_limits<int>::max()};
+    //! File being waited for by Get
+    int m_wanted GUARDED_BY(m_mutex){0};
+    std::map<int, std::vector<BlockFileRecord>> m_scanned GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+
+    std::vector<std::thread> m_threads;
+
+    void ThreadScan() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            int file_num;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+                    return m_stop || (m_next < m_end && m_next < m_wanted + m_lookahead);
+                });
+                if (m_stop) return;
+                file_num = m_next++;
+            }
+
+            std::optional<std::vector<BlockFileRecord>> records;
+            const FlatFilePos pos(file_num, 0);
+            if (fs::exists(m_chainman.m_blockman.GetBlockPosFilename(pos))) {
+                CAutoFile file{m_chainman.m_blockman.OpenBlockFile(pos, true)};
+                if (!file.IsNull()) { // The error is logged in OpenBlockFile
+                    records = m_chainman.ScanBlockFile(file, file_num);
+                }
+            }
+
+            {
+                LOCK(m_mutex);
+                if (records) {
+                    m_scanned.emplace(file_num, std::move(*records));
+                } else {
+                    m_end = std::min(m_end, file_num);
+                }
+            }
+            m_cv.notify_all();
+        }
+    }
+};
+
 void ImportBlocks(ChainstateManager& chainman, std::vector<fs::path> vImportFiles)
 {
     ScheduleBatchPriority();
@@ -1146,17 +1754,17 @@ void ImportBlocks(ChainstateManager& chainman, std::vector<fs::path> vImportFile
             // Map of disk positions for blocks with unknown parent (only used for reindex);
             // parent hash -> child disk position, multiple children can have the same parent.
             std::multimap<uint256, FlatFilePos> blocks_with_unknown_parent;
+            // Reading and hashing the blocks is done on other threads, while the
+            // blocks are processed in file order on this one.
+            const int scan_threads{std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, MAX_REINDEX_SCAN_THREADS)};
+            BlockFileScanner scanner{chainman, scan_threads};
             while (true) {
-                FlatFilePos pos(nFile, 0);
-                if (!fs::exists(chainman.m_blockman.GetBlockPosFilename(pos))) {
+                auto records{scanner.Get(nFile)};
+                if (!records) {
                     break; // No block files left to reindex
                 }
-                CAutoFile file{chainman.m_blockman.OpenBlockFile(pos, true)};
-                if (file.IsNull()) {
-                    break; // This error is logged in OpenBlockFile
-                }
                 LogPrintf("Reindexing block file blk%05u.dat...\n", (unsigned int)nFile);
-                chainman.LoadExternalBlockFile(file, &pos, &blocks_with_unknown_parent);
+                chainman.LoadBlockFileRecords(std::move(*records), blocks_with_unknown_parent);
                 if (chainman.m_interrupt) {
                     LogPrintf("Interrupt requested. Exit %s\n", __func__);
                     return;
@@ -1200,6 +1808,58 @@ void ImportBlocks(ChainstateManager& chainman, std::vector<fs::path> vImportFile
     } // End scope of ImportingNow
 }
 
+void DefragBlockFiles(ChainstateManager& chainman)
+{
+    BlockManager& blockman{chainman.m_blockman};
+    const auto range{WITH_LOCK(::cs_main, return blockman.StartDefrag(chainman.ActiveChain()))};
+    if (!range) return;
+    LogPrintf("Defragmenting block files, moving blk%05u.dat to blk%05u.dat...\n", range->first_moved, range->first_new - 1);
+
+    // Move the blocks of the active chain first, in order. Take cs_main for
+    // each block only, so the node keeps running meanwhile.
+    int last_logged{0};
+    for (int height{0}; true; ++height) {
+        if (chainman.m_interrupt) {
+            LogPrintf("Interrupt requested. Exit %s\n", __func__);
+            return;
+        }
+        LOCK(::cs_main);
+        CBlockIndex* index{chainman.ActiveChain()[height]};
+        if (!index) break;
+        if (!blockman.MoveBlockData(*index, *range)) {
+            chainman.GetNotifications().fatalError(strprintf("Failed to move block %s", index->GetBlockHash().ToString()));
+            return;
+        }
+        if (height - last_logged >= 10000) {
+            LogPrintf("Defragmenting block files, at height %d\n", height);
+            last_logged = height;
+        }
+    }
+
+    // Then blocks that are not in the active chain.
+    std::vector<CBlockIndex*> others{WITH_LOCK(::cs_main, return blockman.GetAllBlockIndices())};
+    std::sort(others.begin(), others.end(), CBlockIndexHeightOnlyComparator());
+    for (CBlockIndex* index : others) {
+        if (chainman.m_interrupt) {
+            LogPrintf("Interrupt requested. Exit %s\n", __func__);
+            return;
+        }
+        LOCK(::cs_main);
+        if (!blockman.MoveBlockData(*index, *range)) {
+            chainman.GetNotifications().fatalError(strprintf("Failed to move block %s", index->GetBlockHash().ToString()));
+            return;
+        }
+    }
+
+    // The new positions must be on disk before the old files are deleted.
+    for (Chainstate* chainstate : WITH_LOCK(::cs_main, return chainman.GetAll())) {
+        chainstate->ForceFlushStateToDisk();
+    }
+    if (!blockman.FinishDefrag(*range)) {
+        chainman.GetNotifications().fatalError("Failed to renumber block files");
+    }
+}
+
 std::ostream& operator<<(std::ostream& os, const BlockfileType& type) {
     switch(type) {
         case BlockfileType::NORMAL: os << "normal"; break;
@@ -13,16 +13,24 @@
 #include <kernel/chainparams.h>
 #include <kernel/cs_main.h>
 #include <kernel/messagestartchars.h>
+#include <node/blockfile_pruner.h>
+#include <node/blockfile_writer.h>
+#include <node/mapped_file.h>
+#include <node/undo_cache.h>
+#include <span.h>
 #include <sync.h>
 #include <util/fs.h>
 #include <util/hasher.h>
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <limits>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -53,6 +61,7 @@ public:
     using CDBWrapper::CDBWrapper;
     bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*>>& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo);
     bool ReadBlockFileInfo(int nFile, CBlockFileInfo& info);
+    bool EraseBlockFileInfo(int nFile);
     bool ReadLastBlockFile(int& nFile);
     bool WriteReindexing(bool fReindexing);
     void ReadReindexing(bool& fReindexing);
@@ -72,10 +81,29 @@ static const unsigned int BLOCKFILE_CHUNK_SIZE = 0x1000000; // 16 MiB
 static const unsigned int UNDOFILE_CHUNK_SIZE = 0x100000; // 1 MiB
 /** The maximum size of a blk?????.dat file (since 0.8) */
 static const unsigned int MAX_BLOCKFILE_SIZE = 0x8000000; // 128 MiB
+/** The amount of block and undo data queued for writing before validation waits for the disk (-asyncblockwrites) */
+static constexpr size_t MAX_PENDING_BLOCK_WRITE_BYTES{64 << 20}; // 64 MiB
+/**
+ * The maximum number of threads reading blocks from the block files during
+ * -reindex. Block hashing is serialized by the proof-of-work code, and each
+ * thread holds a decoded block file in memory, so more do not help.
+ */
+static constexpr int MAX_REINDEX_SCAN_THREADS{2};
+/** The pause between deleting two pruned block files (-backgroundprune) */
+static constexpr auto BACKGROUND_PRUNE_INTERVAL{std::chrono::milliseconds{100}};
+/** The maximum number of threads reading undo data for PrefetchUndo */
+static constexpr size_t MAX_UNDO_PREFETCH_THREADS{8};
 
 /** Size of header written by WriteBlockToDisk before a serialized CBlock */
 static constexpr size_t BLOCK_SERIALIZATION_HEADER_SIZE = std::tuple_size_v<MessageStartChars> + sizeof(unsigned int);
 
+/**
+ * Set in the size field of that header when the record holds a block in the
+ * BlockCompression format rather than a serialized CBlock (-blockcompression).
+ * Record sizes never reach it, as they are limited to MAX_SIZE.
+ */
+static constexpr unsigned int BLOCK_COMPRESSED_FLAG{1U << 31};
+
 extern std::atomic_bool fReindex;
 
 // Because validation code takes pointers to the map's CBlockIndex objects, if
@@ -84,6 +112,13 @@ extern std::atomic_bool fReindex;
 // containers), or make the key a `std::unique_ptr<CBlockIndex>`
 using BlockMap = std::unordered_map<uint256, CBlockIndex, BlockHasher>;
 
+/** The serialized bytes of a block, viewed in place in a memory-mapped block file. */
+struct RawBlockView {
+    //! Keeps the mapping alive while the view is in use.
+    std::shared_ptr<const MappedFile> file;
+    Span<const std::byte> data;
+};
+
 struct CBlockIndexWorkComparator {
     bool operator()(const CBlockIndex* pa, const CBlockIndex* pb) const;
 };
@@ -125,6 +160,15 @@ struct BlockfileCursor {
 
 std::ostream& operator<<(std::ostream& os, const BlockfileCursor& cursor);
 
+/** The block files rewritten by -defragblocks, see BlockManager::StartDefrag. */
+struct DefragRange {
+    //! The first file not in chain order. It and the files after it, up to
+    //! first_new, are rewritten.
+    int first_moved;
+    //! The file the first moved block is written to.
+    int first_new;
+};
+
 
 /**
  * Maintains a tree of blocks (stored in `m_block_index`) which is consulted
@@ -155,6 +199,24 @@ private:
     /** Return false if undo file flushing fails. */
     [[nodiscard]] bool FlushUndoFile(int block_file, bool finalize = false);
 
+    /** Flush the block and undo files up to the given positions. Return false if flushing fails. */
+    bool FlushFiles(std::optional<FlatFilePos> block_pos, bool finalize, std::optional<FlatFilePos> undo_pos, bool finalize_undo) const;
+
+    std::unique_ptr<BlockFileWriter> MakeBlockFileWriter();
+    std::unique_ptr<BlockFilePruner> MakeBlockFilePruner() const;
+
+    /** Delete the block and undo files with number file_num. */
+    void UnlinkPrunedFile(int file_num) const;
+
+    /** Give the block and undo files with number from the number to, see FinishDefrag. */
+    bool RenumberBlockFile(int from, int to) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    /** Wait for queued writes to the block (or undo) file file_num, so it can be read. */
+    void WaitForFileWrites(bool undo, int file_num) const;
+
+    /** Whether a queued block or undo write has failed, so data referenced by the block index may be missing. */
+    bool BlockWritesFailed() const { return m_block_writer && m_block_writer->Failed(); }
+
     [[nodiscard]] bool FindBlockPos(FlatFilePos& pos, unsigned int nAddSize, unsigned int nHeight, uint64_t nTime, bool fKnown);
     [[nodiscard]] bool FlushChainstateBlockFile(int tip_height);
     bool FindUndoPos(BlockValidationState& state, int nFile, FlatFilePos& pos, unsigned int nAddSize);
@@ -164,8 +226,19 @@ private:
 
     CAutoFile OpenUndoFile(const FlatFilePos& pos, bool fReadOnly = false) const;
 
-    bool WriteBlockToDisk(const CBlock& block, FlatFilePos& pos) const;
+    /** Write block, or its compressed record if one is given, to the end of the block file at pos */
+    bool WriteBlockToDisk(const CBlock& block, FlatFilePos& pos, Span<const std::byte> compressed = {}) const;
+
+    /**
+     * Locate the block record at pos in its memory-mapped block file, setting
+     * compressed if the record is in the BlockCompression format.
+     */
+    std::optional<RawBlockView> MapBlockRecord(const FlatFilePos& pos, bool& compressed) const;
+    /** Deserialize the block at pos, without checking its header. */
+    bool ReadBlockRecord(CBlock& block, const FlatFilePos& pos) const;
     bool UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const uint256& hashBlock) const;
+    /** Read and verify the undo data at pos of the block whose parent is prev_hash. */
+    bool ReadUndoRecord(CBlockUndo& blockundo, const FlatFilePos& pos, const uint256& prev_hash) const;
 
     /* Calculate the block/rev files to delete based on height specified by user with RPC command pruneblockchain */
     void FindFilesToPruneManual(
@@ -248,15 +321,32 @@ private:
 
     const kernel::BlockManagerOpts m_opts;
 
+    /** Memory-mapped blk?????.dat files, used to serve block reads without file syscalls. */
+    mutable MappedFileCache m_mapped_block_files;
+
+    /** Background writer for block and undo data, if writes are asynchronous. */
+    std::unique_ptr<BlockFileWriter> m_block_writer;
+
+    /** Background deleter of pruned files, if -backgroundprune is set. */
+    std::unique_ptr<BlockFilePruner> m_pruner;
+
 public:
     using Options = kernel::BlockManagerOpts;
 
     explicit BlockManager(const util::SignalInterrupt& interrupt, Options opts)
         : m_prune_mode{opts.prune_target > 0},
           m_opts{std::move(opts)},
-          m_interrupt{interrupt} {};
+          m_mapped_block_files{static_cast<size_t>(std::max(m_opts.blockfile_maps, 0))},
+          m_block_writer{m_opts.async_writes ? MakeBlockFileWriter() : nullptr},
+          m_pruner{m_prune_mode && m_opts.background_prune ? MakeBlockFilePruner() : nullptr},
+          m_interrupt{interrupt},
+          m_undo_cache{m_opts.undo_cache_bytes} {};
 
     const util::SignalInterrupt& m_interrupt;
+
+    /** Recently read undo data, see UndoReadFromDisk. */
+    mutable BlockUndoCache m_undo_cache;
+
     std::atomic<bool> m_importing{false};
 
     BlockMap m_block_index GUARDED_BY(cs_main);
@@ -349,6 +439,31 @@ public:
     //! Create or update a prune lock identified by its name
     void UpdatePruneLock(const std::string& name, const PruneLockInfo& lock_info) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
+    /**
+     * Start rewriting the block files (-defragblocks): new blocks, and blocks
+     * moved by MoveBlockData, go to files after all existing ones. The leading
+     * files that hold the first blocks of chain in order, and nothing else,
+     * are kept. Returns nullopt, and logs why, if there is nothing to do:
+     * the files were defragmented before, are already in order, can not be
+     * defragmented in this mode, or there is not enough disk space for the
+     * copy.
+     */
+    std::optional<DefragRange> StartDefrag(const CChain& chain) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    /**
+     * Copy the block and undo data of index to the end of the block files, if
+     * it is stored in one of the files being rewritten. Returns false on failure.
+     */
+    bool MoveBlockData(CBlockIndex& index, const DefragRange& range) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    /**
+     * Once MoveBlockData was called for every block stored in the rewritten
+     * files, and the new positions were flushed to disk, delete those files,
+     * renumber the new ones to follow the kept ones, and record that the
+     * block files were defragmented.
+     */
+    bool FinishDefrag(const DefragRange& range) LOCKS_EXCLUDED(::cs_main);
+
     /** Open a block file (blk?????.dat) */
     CAutoFile OpenBlockFile(const FlatFilePos& pos, bool fReadOnly = false) const;
 
@@ -356,21 +471,57 @@ public:
     fs::path GetBlockPosFilename(const FlatFilePos& pos) const;
 
     /**
-     *  Actually unlink the specified files
+     *  Actually unlink the specified files, or queue them for the background
+     *  pruner with -backgroundprune
      */
     void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune) const;
 
     /** Functions for disk access for blocks */
     bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos) const;
     bool ReadBlockFromDisk(CBlock& block, const CBlockIndex& index) const;
+    /**
+     * Read the block of index from pos, which the caller looked up under
+     * cs_main. Instead of recomputing the proof-of-work hash, the header is
+     * compared with the one of the index, which was checked when the index
+     * entry was added.
+     */
+    bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const CBlockIndex& index) const;
     bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos) const;
 
+    /**
+     * Return a view of the serialized block at pos in its memory-mapped block
+     * file, without copying it. Returns std::nullopt if block files are not
+     * mapped or the block can not be located in the mapping; callers should
+     * then fall back to ReadRawBlockFromDisk, which reports the error.
+     */
+    std::optional<RawBlockView> ReadRawBlockView(const FlatFilePos& pos) const;
+
+    /**
+     * Whether the block at pos is stored in the BlockCompression format
+     * (-blockcompression), so its transactions are not at the offsets of the
+     * network serialization.
+     */
+    bool IsCompressedBlockRecord(const FlatFilePos& pos) const;
+
+    /** Read the undo data of a block, from the undo cache if it is there. */
     bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex& index) const;
 
+    /**
+     * Read the undo data of several blocks into the undo cache on parallel
+     * threads, ahead of reading them one by one with UndoReadFromDisk, e.g.
+     * when disconnecting several blocks. blocks are in the order they will be
+     * read in. Only as many blocks as fit in the cache are read, the first
+     * ones first. cs_main is only taken to look up the undo positions.
+     */
+    void PrefetchUndo(const std::vector<const CBlockIndex*>& blocks) const LOCKS_EXCLUDED(::cs_main);
+
     void CleanupBlockRevFiles() const;
 };
 
 void ImportBlocks(ChainstateManager& chainman, std::vector<fs::path> vImportFiles);
+
+/** Rewrite the block files in chain order (-defragblocks), see BlockManager::StartDefrag. */
+void DefragBlockFiles(ChainstateManager& chainman);
 } // namespace node
 
 #endif // OCVCOIN_NODE_BLOCKSTORAGE_H
@@ -6,6 +6,7 @@
 
 #include <arith_uint256.h>
 #include <common/args.h>
+#include <consensus/consensus.h>
 #include <kernel/chainstatemanager_opts.h>
 #include <node/coins_view_args.h>
 #include <node/database_args.h>
@@ -16,6 +17,7 @@
 #include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <chrono>
 #include <string>
 
@@ -37,8 +39,15 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& args, ChainstateManage
 
     if (auto value{args.GetIntArg("-maxtipage")}) opts.max_tip_age = std::chrono::seconds{*value};
 
-    ReadDatabaseArgs(args, opts.block_tree_db);
-    ReadDatabaseArgs(args, opts.coins_db);
+    if (auto value{args.GetIntArg("-loadblockbuffer")}) {
+        opts.loadblock_buffer_bytes = std::max<size_t>(std::clamp<int64_t>(*value, 0, MAX_LOADBLOCK_BUFFER_MB) << 20, 2 * MAX_BLOCK_SERIALIZED_SIZE);
+    }
+
+    if (auto value{args.GetIntArg("-blockprefetch")}) opts.block_prefetch = std::clamp<int64_t>(*value, 0, MAX_BLOCK_PREFETCH);
+
+    if (auto result{CheckDatabaseArgs(args)}; !result) return result;
+    ReadDatabaseArgs(args, opts.block_tree_db, "blocks");
+    ReadDatabaseArgs(args, opts.coins_db, "chainstate");
     ReadCoinsViewArgs(args, opts.coins_view);
 
     return {};
@@ -0,0 +1,22 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/coinscache_persist_args.h>
+
+#include <common/args.h>
+#include <util/fs.h>
+
+namespace node {
+
+bool ShouldPersistCoinsCache(const ArgsManager& argsman)
+{
+    return argsman.GetBoolArg("-persistcoinscache", DEFAULT_PERSIST_COINSCACHE);
+}
+
+fs::path CoinsCachePath(const ArgsManager& argsman)
+{
+    return argsman.GetDataDirNet() / "coinscache.dat";
+}
+
+} // namespace node
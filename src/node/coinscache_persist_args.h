@@ -0,0 +1,25 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OCVCOIN_NODE_COINSCACHE_PERSIST_ARGS_H
+#define OCVCOIN_NODE_COINSCACHE_PERSIST_ARGS_H
+
+#include <util/fs.h>
+
+class ArgsManager;
+
+namespace node {
+
+/**
+ * Default for -persistcoinscache, indicating whether the node should save the
+ * outpoints held in the coins cache on shutdown and prefetch them on start
+ */
+static constexpr bool DEFAULT_PERSIST_COINSCACHE{false};
+
+bool ShouldPersistCoinsCache(const ArgsManager& argsman);
+fs::path CoinsCachePath(const ArgsManager& argsman);
+
+} // namespace node
+
+#endif // OCVCOIN_NODE_COINSCACHE_PERSIST_ARGS_H
@@ -6,13 +6,113 @@
 
 #include <common/args.h>
 #include <dbwrapper.h>
+#include <tinyformat.h>
+#include <util/result.h>
+#include <util/translation.h>
+
+#include <algorithm>
+#include <array>
+#include <utility>
 
 namespace node {
-void ReadDatabaseArgs(const ArgsManager& args, DBOptions& options)
+static constexpr std::array<std::pair<std::string_view, DBProfile>, 3> DB_PROFILE_NAMES{{
+    {"default", DBProfile::DEFAULT},
+    {"ssd", DBProfile::SSD},
+    {"lowmem", DBProfile::LOWMEM},
+}};
+
+static constexpr std::array<std::string_view, 3> DB_PROFILE_DATABASES{"chainstate", "blocks", "indexes"};
+
+std::optional<DBProfile> DBProfileFromString(std::string_view name)
+{
+    for (const auto& [profile_name, profile] : DB_PROFILE_NAMES) {
+        if (profile_name == name) return profile;
+    }
+    return std::nullopt;
+}
+
+std::string DBProfileNames()
+{
+    std::string names;
+    for (const auto& [profile_name, profile] : DB_PROFILE_NAMES) {
+        if (!names.empty()) names += ", ";
+        names += profile_name;
+    }
+    return names;
+}
+
+void ApplyDBProfile(DBProfile profile, DBOptions& options)
+{
+    const DBOptions defaults{};
+    options.bloom_filter_bits = defaults.bloom_filter_bits;
+    options.block_size = defaults.block_size;
+    options.write_buffer_size = defaults.write_buffer_size;
+    options.max_file_size = defaults.max_file_size;
+    options.compression = defaults.compression;
+
+    switch (profile) {
+    case DBProfile::DEFAULT:
+        return;
+    case DBProfile::SSD:
+        // Fewer, larger table files and index entries; random reads are cheap
+        // enough that the larger block size does not hurt point lookups.
+        options.block_size = 16 << 10;
+        options.max_file_size = 32 << 20;
+        return;
+    case DBProfile::LOWMEM:
+        // Keep memtables small so more of the cache budget is left for the
+        // block cache, and trade some CPU for disk space.
+        options.write_buffer_size = 4 << 20;
+        options.compression = true;
+        return;
+    } // no default case, so the compiler can warn about missing cases
+}
+
+//! Split a -dbprofile value into an optional database name and a profile name.
+static std::pair<std::string_view, std::string_view> SplitDBProfileArg(std::string_view value)
+{
+    const auto sep{value.find(':')};
+    if (sep == std::string_view::npos) return {{}, value};
+    return {value.substr(0, sep), value.substr(sep + 1)};
+}
+
+void ReadDatabaseArgs(const ArgsManager& args, DBOptions& options, std::string_view db_name)
 {
     // Settings here apply to all databases (chainstate, blocks, and index
-    // databases), but it'd be easy to parse database-specific options by adding
-    // a database_type string or enum parameter to this function.
+    // databases) unless they are prefixed with a database name.
     if (auto value = args.GetBoolArg("-forcecompactdb")) options.force_compact = *value;
+
+    // Later values take precedence, and database-specific values take
+    // precedence over ones that apply to all databases.
+    std::optional<DBProfile> global_profile, db_profile;
+    for (const std::string& value : args.GetArgs("-dbprofile")) {
+        const auto [db, name]{SplitDBProfileArg(value)};
+        const auto profile{DBProfileFromString(name)};
+        if (!profile) continue;
+        if (db.empty()) {
+            global_profile = profile;
+        } else if (db == db_name) {
+            db_profile = profile;
+        }
+    }
+    if (db_profile) {
+        ApplyDBProfile(*db_profile, options);
+    } else if (global_profile) {
+        ApplyDBProfile(*global_profile, options);
+    }
+}
+
+util::Result<void> CheckDatabaseArgs(const ArgsManager& args)
+{
+    for (const std::string& value : args.GetArgs("-dbprofile")) {
+        const auto [db, name]{SplitDBProfileArg(value)};
+        if (!db.empty() && std::find(DB_PROFILE_DATABASES.begin(), DB_PROFILE_DATABASES.end(), db) == DB_PROFILE_DATABASES.end()) {
+            return util::Error{strprintf(Untranslated("Unknown database in -dbprofile=%s"), value)};
+        }
+        if (!DBProfileFromString(name)) {
+            return util::Error{strprintf(Untranslated("Unknown profile in -dbprofile=%s (available: %s)"), value, DBProfileNames())};
+        }
+    }
+    return {};
 }
 } // namespace node
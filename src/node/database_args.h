@@ -5,11 +5,38 @@
 #ifndef OCVCOIN_NODE_DATABASE_ARGS_H
 #define OCVCOIN_NODE_DATABASE_ARGS_H
 
+#include <util/result.h>
+
+#include <optional>
+#include <string>
+#include <string_view>
+
 class ArgsManager;
 struct DBOptions;
 
 namespace node {
-void ReadDatabaseArgs(const ArgsManager& args, DBOptions& options);
+//! Named sets of leveldb tuning parameters, selected with -dbprofile.
+enum class DBProfile {
+    DEFAULT, //!< Stock leveldb settings, suitable for most hardware.
+    SSD,     //!< Larger blocks and table files for fast random-access storage.
+    LOWMEM,  //!< Small write buffer and compressed blocks for constrained devices.
+};
+
+std::optional<DBProfile> DBProfileFromString(std::string_view name);
+std::string DBProfileNames();
+void ApplyDBProfile(DBProfile profile, DBOptions& options);
+
+/**
+ * Read database options from args.
+ *
+ * @param[in] db_name  Name of the database ("chainstate", "blocks" or
+ *                     "indexes"), used to apply -dbprofile=<db>:<profile>.
+ *                     Settings without a database prefix apply to all.
+ */
+void ReadDatabaseArgs(const ArgsManager& args, DBOptions& options, std::string_view db_name = "");
+
+/** Check that all -dbprofile values name a known database and profile. */
+util::Result<void> CheckDatabaseArgs(const ArgsManager& args);
 } // namespace node
 
 #endif // OCVCOIN_NODE_DATABASE_ARGS_H
@@ -0,0 +1,84 @@
+// Copyright (c) 2023 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/mapped_file.h>
+
+#include <logging.h>
+#include <sync.h>
+#include <util/fs.h>
+#include <util/syserror.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace node {
+
+std::shared_ptr<const MappedFile> MappedFile::Open(const fs::path& path)
+{
+#ifndef WIN32
+    int fd{::open(path.c_str(), O_RDONLY)};
+    if (fd == -1) return nullptr;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    const size_t size{static_cast<size_t>(st.st_size)};
+    void* addr{::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0)};
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        LogPrint(BCLog::BLOCKSTORAGE, "Failed to map %s: %s\n", fs::PathToString(path), SysErrorString(errno));
+        return nullptr;
+    }
+    return std::shared_ptr<const MappedFile>{new MappedFile{static_cast<const std::byte*>(addr), size}};
+#else
+    return nullptr;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef WIN32
+    ::munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+}
+
+std::shared_ptr<const MappedFile> MappedFileCache::Get(int file_num, const fs::path& path, size_t min_size)
+{
+    if (m_max_files == 0) return nullptr;
+
+    LOCK(m_mutex);
+    auto it{std::find_if(m_files.begin(), m_files.end(), [&](const auto& entry) { return entry.first == file_num; })};
+    if (it != m_files.end()) {
+        if (it->second->Data().size() >= min_size) {
+            m_files.splice(m_files.begin(), m_files, it);
+            return m_files.front().second;
+        }
+        m_files.erase(it);
+    }
+
+    auto file{MappedFile::Open(path)};
+    if (!file || file->Data().size() < min_size) return nullptr;
+
+    m_files.emplace_front(file_num, file);
+    if (m_files.size() > m_max_files) m_files.pop_back();
+    return file;
+}
+
+void MappedFileCache::Erase(int file_num)
+{
+    LOCK(m_mutex);
+    m_files.remove_if([&](const auto& entry) { return entry.first == file_num; });
+}
+
+} // namespace node
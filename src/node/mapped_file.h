@@ -0,0 +1,74 @@
+// Copyright (c) 2023 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OCVCOIN_NODE_MAPPED_FILE_H
+#define OCVCOIN_NODE_MAPPED_FILE_H
+
+#include <span.h>
+#include <sync.h>
+#include <util/fs.h>
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <utility>
+
+namespace node {
+
+/** A read-only, shared memory mapping of a whole file. */
+class MappedFile
+{
+    const std::byte* m_data;
+    size_t m_size;
+
+    MappedFile(const std::byte* data, size_t size) : m_data{data}, m_size{size} {}
+
+public:
+    /**
+     * Map the file at path. Returns nullptr if the file is empty or can not be
+     * mapped, in which case callers should fall back to regular file reads.
+     */
+    static std::shared_ptr<const MappedFile> Open(const fs::path& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    Span<const std::byte> Data() const { return {m_data, m_size}; }
+};
+
+/**
+ * A least-recently-used set of mapped files, keyed by file number.
+ *
+ * Mappings are handed out as shared pointers, so a mapping evicted or
+ * invalidated while a reader still uses it stays valid until that reader
+ * drops it.
+ */
+class MappedFileCache
+{
+    const size_t m_max_files;
+
+    Mutex m_mutex;
+    //! Most recently used first.
+    std::list<std::pair<int, std::shared_ptr<const MappedFile>>> m_files GUARDED_BY(m_mutex);
+
+public:
+    explicit MappedFileCache(size_t max_files) : m_max_files{max_files} {}
+
+    /**
+     * Return a mapping of file number file_num at path covering at least
+     * min_size bytes. A cached mapping which is too short, because the file
+     * has grown since it was mapped, is replaced. Returns nullptr if the
+     * cache is disabled or the file can not be mapped.
+     */
+    std::shared_ptr<const MappedFile> Get(int file_num, const fs::path& path, size_t min_size) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Drop the mapping of file_num, e.g. because the file is being deleted. */
+    void Erase(int file_num) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+
+} // namespace node
+
+#endif // OCVCOIN_NODE_MAPPED_FILE_H
@@ -20,4 +20,9 @@ fs::path MempoolPath(const ArgsManager& argsman)
     return argsman.GetDataDirNet() / "mempool.dat";
 }
 
+fs::path ValidationCachePath(const ArgsManager& argsman)
+{
+    return argsman.GetDataDirNet() / "validationcache.dat";
+}
+
 } // namespace node
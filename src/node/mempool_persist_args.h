@@ -19,6 +19,8 @@ static constexpr bool DEFAULT_PERSIST_MEMPOOL{true};
 
 bool ShouldPersistMempool(const ArgsManager& argsman);
 fs::path MempoolPath(const ArgsManager& argsman);
+//! The signature and script-execution caches are persisted along with the mempool.
+fs::path ValidationCachePath(const ArgsManager& argsman);
 
 } // namespace node
 
@@ -0,0 +1,61 @@
+// Copyright (c) 2023 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/undo_cache.h>
+
+#include <coins.h>
+#include <memusage.h>
+#include <undo.h>
+
+namespace node {
+
+size_t BlockUndoUsage(const CBlockUndo& blockundo)
+{
+    size_t usage{memusage::MallocUsage(sizeof(CBlockUndo)) + memusage::DynamicUsage(blockundo.vtxundo)};
+    for (const CTxUndo& txundo : blockundo.vtxundo) {
+        usage += memusage::DynamicUsage(txundo.vprevout);
+        for (const Coin& coin : txundo.vprevout) {
+            usage += coin.DynamicMemoryUsage();
+        }
+    }
+    return usage;
+}
+
+std::shared_ptr<const CBlockUndo> BlockUndoCache::Get(const uint256& block_hash)
+{
+    LOCK(m_mutex);
+    const auto it{m_index.find(block_hash)};
+    if (it == m_index.end()) return nullptr;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->undo;
+}
+
+bool BlockUndoCache::Contains(const uint256& block_hash) const
+{
+    return WITH_LOCK(m_mutex, return m_index.count(block_hash) > 0);
+}
+
+void BlockUndoCache::Insert(const uint256& block_hash, std::shared_ptr<const CBlockUndo> undo)
+{
+    const size_t usage{BlockUndoUsage(*undo)};
+    if (usage > m_max_usage) return;
+
+    LOCK(m_mutex);
+    if (m_index.count(block_hash)) return;
+    while (m_usage + usage > m_max_usage) {
+        m_usage -= m_entries.back().usage;
+        m_index.erase(m_entries.back().block_hash);
+        m_entries.pop_back();
+    }
+    m_entries.push_front({block_hash, std::move(undo), usage});
+    m_index.emplace(block_hash, m_entries.begin());
+    m_usage += usage;
+}
+
+size_t BlockUndoCache::Usage() const
+{
+    return WITH_LOCK(m_mutex, return m_usage);
+}
+
+} // namespace node
@@ -0,0 +1,65 @@
+// Copyright (c) 2023 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OCVCOIN_NODE_UNDO_CACHE_H
+#define OCVCOIN_NODE_UNDO_CACHE_H
+
+#include <sync.h>
+#include <uint256.h>
+#include <util/hasher.h>
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+class CBlockUndo;
+
+namespace node {
+
+/** Approximate memory usage of a decoded CBlockUndo. */
+size_t BlockUndoUsage(const CBlockUndo& blockundo);
+
+/**
+ * A least-recently-used set of decoded block undo data, keyed by block hash
+ * and limited by memory usage. Undo data is written once per block and never
+ * changes, so entries need no invalidation.
+ */
+class BlockUndoCache
+{
+    struct Entry {
+        uint256 block_hash;
+        std::shared_ptr<const CBlockUndo> undo;
+        size_t usage;
+    };
+
+    const size_t m_max_usage;
+
+    mutable Mutex m_mutex;
+    //! Most recently used first.
+    std::list<Entry> m_entries GUARDED_BY(m_mutex);
+    std::unordered_map<uint256, std::list<Entry>::iterator, BlockHasher> m_index GUARDED_BY(m_mutex);
+    size_t m_usage GUARDED_BY(m_mutex){0};
+
+public:
+    explicit BlockUndoCache(size_t max_usage) : m_max_usage{max_usage} {}
+
+    bool IsEnabled() const { return m_max_usage > 0; }
+
+    size_t MaxUsage() const { return m_max_usage; }
+
+    /** Return the undo data of block_hash, or nullptr if it is not cached. */
+    std::shared_ptr<const CBlockUndo> Get(const uint256& block_hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    bool Contains(const uint256& block_hash) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Add the undo data of block_hash, evicting the least recently used entries to stay within the limit. */
+    void Insert(const uint256& block_hash, std::shared_ptr<const CBlockUndo> undo) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    size_t Usage() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+
+} // namespace node
+
+#endif // OCVCOIN_NODE_UNDO_CACHE_H
@@ -4,7 +4,9 @@
 
 #include <node/utxo_snapshot.h>
 
+#include <hash.h>
 #include <logging.h>
+#include <serialize.h>
 #include <streams.h>
 #include <sync.h>
 #include <tinyformat.h>
@@ -15,6 +17,7 @@
 
 #include <cassert>
 #include <cstdio>
+#include <limits>
 #include <optional>
 #include <string>
 
@@ -81,6 +84,94 @@ std::optional<uint256> ReadSnapshotBaseBlockhash(fs::path chaindir)
     return base_blockhash;
 }
 
+SnapshotChunkWriter::SnapshotChunkWriter(AutoFile& file, uint64_t offset)
+    : m_file{file}, m_offset{offset} {}
+
+void SnapshotChunkWriter::Add(const COutPoint& outpoint, const Coin& coin)
+{
+    if (!m_outputs.empty() && outpoint.hash != m_txid) {
+        WriteOutputs();
+        if (m_chunk_coins >= SNAPSHOT_CHUNK_COINS) WriteChunk();
+    }
+    m_txid = outpoint.hash;
+    m_outputs.emplace_back(outpoint.n, coin);
+}
+
+void SnapshotChunkWriter::Finish()
+{
+    if (!m_outputs.empty()) WriteOutputs();
+    if (m_chunk_coins > 0) WriteChunk();
+    m_file << m_index << m_offset;
+}
+
+void SnapshotChunkWriter::WriteOutputs()
+{
+    m_payload << m_txid;
+    WriteCompactSize(m_payload, m_outputs.size());
+    for (const auto& [n, coin] : m_outputs) {
+        WriteCompactSize(m_payload, n);
+        m_payload << coin;
+    }
+    m_chunk_coins += m_outputs.size();
+    m_outputs.clear();
+}
+
+void SnapshotChunkWriter::WriteChunk()
+{
+    m_index.push_back({m_offset, m_chunk_coins});
+    m_file << m_chunk_coins;
+    WriteCompactSize(m_file, m_payload.size());
+    m_file.write(m_payload);
+    m_file << SnapshotChunkChecksum(m_payload);
+    m_offset += sizeof(m_chunk_coins) + GetSizeOfCompactSize(m_payload.size()) + m_payload.size() + uint256::size();
+    m_payload.clear();
+    m_chunk_coins = 0;
+}
+
+uint256 SnapshotChunkChecksum(Span<const std::byte> payload)
+{
+    return (HashWriter{} << payload).GetHash();
+}
+
+uint64_t ReadSnapshotChunk(AutoFile& file, std::vector<std::pair<COutPoint, Coin>>& coins)
+{
+    uint32_t coins_count;
+    file >> coins_count;
+    DataStream payload{};
+    payload.resize(ReadCompactSize(file));
+    file.read(payload);
+    uint256 checksum;
+    file >> checksum;
+    if (checksum != SnapshotChunkChecksum(payload)) {
+        throw std::ios_base::failure("Snapshot chunk checksum mismatch");
+    }
+    const uint64_t chunk_size{sizeof(coins_count) + GetSizeOfCompactSize(payload.size()) + payload.size() + uint256::size()};
+
+    uint64_t coins_read{0};
+    while (!payload.empty()) {
+        uint256 txid;
+        payload >> txid;
+        const uint64_t outputs{ReadCompactSize(payload)};
+        if (outputs == 0) {
+            throw std::ios_base::failure("Snapshot chunk contains a txid without outputs");
+        }
+        for (uint64_t i = 0; i < outputs; ++i) {
+            const uint64_t n{ReadCompactSize(payload, /*range_check=*/false)};
+            if (n > std::numeric_limits<uint32_t>::max()) {
+                throw std::ios_base::failure("Snapshot chunk output index out of range");
+            }
+            Coin coin;
+            payload >> coin;
+            coins.emplace_back(COutPoint{txid, static_cast<uint32_t>(n)}, std::move(coin));
+            ++coins_read;
+        }
+    }
+    if (coins_read != coins_count) {
+        throw std::ios_base::failure("Snapshot chunk coins count mismatch");
+    }
+    return chunk_size;
+}
+
 std::optional<fs::path> FindSnapshotChainstateDir(const fs::path& data_dir)
 {
     fs::path possible_dir =
@@ -6,24 +6,50 @@
 #ifndef OCVCOIN_NODE_UTXO_SNAPSHOT_H
 #define OCVCOIN_NODE_UTXO_SNAPSHOT_H
 
+#include <coins.h>
 #include <kernel/cs_main.h>
+#include <primitives/transaction.h>
 #include <serialize.h>
+#include <streams.h>
 #include <sync.h>
 #include <uint256.h>
 #include <util/fs.h>
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <ios>
 #include <optional>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 class Chainstate;
 
 namespace node {
+//! Magic bytes at the start of snapshot files newer than version 1, which
+//! begin directly with the base block hash. The last byte is the most
+//! significant one of a serialized uint256. Every block hash is at most
+//! powLimit, whose most significant byte is 0x7f on all chains, so no
+//! version 1 file can start with these bytes.
+static constexpr std::array<uint8_t, 32> SNAPSHOT_MAGIC_BYTES{
+    'u', 't', 'x', 'o', 's', 'n', 'a', 'p', 's', 'h', 'o', 't', 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff};
+
+//! The metadata is followed by a flat stream of outpoint/coin pairs.
+static constexpr uint16_t SNAPSHOT_VERSION_FLAT{1};
+//! The metadata is followed by checksummed chunks of coins grouped by txid,
+//! and an index of those chunks. See SnapshotChunkWriter.
+static constexpr uint16_t SNAPSHOT_VERSION_CHUNKED{2};
+
 //! Metadata describing a serialized version of a UTXO set from which an
 //! assumeutxo Chainstate can be constructed.
 class SnapshotMetadata
 {
 public:
+    //! Format of the coins following the metadata.
+    uint16_t m_version{SNAPSHOT_VERSION_FLAT};
+
     //! The hash of the block that reflects the tip of the chain for the
     //! UTXO set contained in this snapshot.
     uint256 m_base_blockhash;
@@ -35,13 +61,104 @@ public:
     SnapshotMetadata() { }
     SnapshotMetadata(
         const uint256& base_blockhash,
-        uint64_t coins_count) :
+        uint64_t coins_count,
+        uint16_t version = SNAPSHOT_VERSION_FLAT) :
+            m_version(version),
             m_base_blockhash(base_blockhash),
             m_coins_count(coins_count) { }
 
-    SERIALIZE_METHODS(SnapshotMetadata, obj) { READWRITE(obj.m_base_blockhash, obj.m_coins_count); }
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        if (m_version != SNAPSHOT_VERSION_FLAT) {
+            s << SNAPSHOT_MAGIC_BYTES << m_version;
+        }
+        s << m_base_blockhash << m_coins_count;
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        // Version 1 files have no magic bytes, so unless they match, the
+        // bytes we just read are the base block hash.
+        s >> m_base_blockhash;
+        if (std::equal(m_base_blockhash.begin(), m_base_blockhash.end(), SNAPSHOT_MAGIC_BYTES.begin())) {
+            s >> m_version;
+            if (m_version != SNAPSHOT_VERSION_CHUNKED) {
+                throw std::ios_base::failure("Unsupported snapshot version");
+            }
+            s >> m_base_blockhash;
+        } else {
+            m_version = SNAPSHOT_VERSION_FLAT;
+        }
+        s >> m_coins_count;
+    }
+};
+
+//! Location and size of one chunk of a version 2 snapshot.
+struct SnapshotChunkInfo {
+    //! Offset of the chunk from the start of the file.
+    uint64_t m_offset{0};
+    //! Number of coins in the chunk.
+    uint32_t m_coins_count{0};
+
+    SERIALIZE_METHODS(SnapshotChunkInfo, obj) { READWRITE(obj.m_offset, obj.m_coins_count); }
 };
 
+//! Approximate number of coins per chunk. Chunks only end between txids.
+static constexpr uint32_t SNAPSHOT_CHUNK_COINS{50000};
+
+/**
+ * Writes the coins of a version 2 snapshot, which must be added in coins
+ * database order, after its metadata.
+ *
+ * Coins are stored in chunks that can be read, verified and loaded
+ * independently. Each chunk is serialized as:
+ *   - uint32 number of coins
+ *   - CompactSize payload length, followed by the payload
+ *   - uint256 hash of the payload, see SnapshotChunkChecksum()
+ * The payload groups outputs by txid, which stores each txid only once:
+ *   - txid, CompactSize number of outputs, and per output:
+ *     CompactSize output index followed by the (compressed) Coin.
+ * The last chunk is followed by the list of SnapshotChunkInfo and, as the
+ * last 8 bytes of the file, the offset of that list.
+ */
+class SnapshotChunkWriter
+{
+public:
+    //! @param[in] offset  Number of bytes already written to the file.
+    SnapshotChunkWriter(AutoFile& file, uint64_t offset);
+
+    void Add(const COutPoint& outpoint, const Coin& coin);
+    //! Write the remaining coins and the chunk index.
+    void Finish();
+
+private:
+    AutoFile& m_file;
+    uint64_t m_offset;
+    DataStream m_payload{};
+    uint32_t m_chunk_coins{0};
+    uint256 m_txid;
+    std::vector<std::pair<uint32_t, Coin>> m_outputs;
+    std::vector<SnapshotChunkInfo> m_index;
+
+    void WriteOutputs();
+    void WriteChunk();
+};
+
+//! Checksum of a chunk payload, which detects corrupted chunks before their
+//! coins are loaded.
+uint256 SnapshotChunkChecksum(Span<const std::byte> payload);
+
+/**
+ * Read one chunk of a version 2 snapshot and append its coins to `coins`.
+ *
+ * @returns the size of the chunk in bytes.
+ * @throws std::ios_base::failure if the chunk is truncated, malformed or
+ *         does not match its checksum.
+ */
+uint64_t ReadSnapshotChunk(AutoFile& file, std::vector<std::pair<COutPoint, Coin>>& coins);
+
 //! The file in the snapshot chainstate dir which stores the base blockhash. This is
 //! needed to reconstruct snapshot chainstates on init.
 //!
@@ -0,0 +1 @@
+#define BUILD_GIT_COMMIT "d56639d13964-dirty"
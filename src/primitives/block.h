@@ -11,6 +11,8 @@
 #include <uint256.h>
 #include <util/time.h>
 
+#include <optional>
+
 /** Nodes collect new transactions into a block, hash them into a hash tree,
  * and scan through nonce values to make the block's hash satisfy proof-of-work
  * requirements.  When they solve the proof-of-work, they broadcast the block
@@ -73,6 +75,8 @@ public:
 
     // memory only
     mutable bool fChecked;
+    //! Witness merkle root, computed along with the merkle root by CheckBlock
+    mutable std::optional<uint256> m_witness_merkle_root;
 
     CBlock()
     {
@@ -95,6 +99,7 @@ public:
         CBlockHeader::SetNull();
         vtx.clear();
         fChecked = false;
+        m_witness_merkle_root.reset();
     }
 
     CBlockHeader GetBlockHeader() const
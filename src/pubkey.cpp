@@ -225,6 +225,56 @@ bool XOnlyPubKey::VerifySchnorr(const uint256& msg, Span<const unsigned char> si
     return secp256k1_schnorrsig_verify(secp256k1_context_static, sigbytes.data(), msg.begin(), 32, &pubkey);
 }
 
+bool BatchSchnorrVerifier::IsSupported()
+{
+#ifdef SECP256K1_SCHNORRSIG_VERIFY_BATCH
+    return true;
+#else
+    return false;
+#endif
+}
+
+void BatchSchnorrVerifier::Add(const XOnlyPubKey& pubkey, const uint256& msg, Span<const unsigned char> sigbytes)
+{
+    assert(sigbytes.size() == 64);
+    Entry& entry{m_entries.emplace_back()};
+    std::copy(sigbytes.begin(), sigbytes.end(), entry.sig.begin());
+    entry.pubkey = pubkey;
+    entry.msg = msg;
+}
+
+bool BatchSchnorrVerifier::Verify() const
+{
+    if (m_entries.empty()) return true;
+#ifdef SECP256K1_SCHNORRSIG_VERIFY_BATCH
+    // Enough scratch space for the multi-scalar multiplication of about 128
+    // signatures at once; larger batches are processed in parts.
+    static constexpr size_t SCRATCH_SIZE{256 << 10};
+
+    std::vector<secp256k1_xonly_pubkey> pubkeys(m_entries.size());
+    std::vector<const secp256k1_xonly_pubkey*> pubkey_ptrs(m_entries.size());
+    std::vector<const unsigned char*> sigs(m_entries.size());
+    std::vector<const unsigned char*> msgs(m_entries.size());
+    const std::vector<size_t> msglens(m_entries.size(), 32);
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        if (!secp256k1_xonly_pubkey_parse(secp256k1_context_static, &pubkeys[i], m_entries[i].pubkey.data())) return false;
+        pubkey_ptrs[i] = &pubkeys[i];
+        sigs[i] = m_entries[i].sig.data();
+        msgs[i] = m_entries[i].msg.begin();
+    }
+    // Without scratch space, verification falls back to a slower algorithm.
+    secp256k1_scratch_space* scratch{secp256k1_scratch_space_create(secp256k1_context_static, SCRATCH_SIZE)};
+    const int ret{secp256k1_schnorrsig_verify_batch(secp256k1_context_static, scratch, sigs.data(), msgs.data(), msglens.data(), pubkey_ptrs.data(), m_entries.size())};
+    if (scratch) secp256k1_scratch_space_destroy(secp256k1_context_static, scratch);
+    return ret;
+#else
+    // The library has no batch verification (see contrib/secp256k1).
+    return std::all_of(m_entries.begin(), m_entries.end(), [](const Entry& entry) {
+        return entry.pubkey.VerifySchnorr(entry.msg, entry.sig);
+    });
+#endif
+}
+
 static const HashWriter HASHER_TAPTWEAK{TaggedHash("TapTweak")};
 
 uint256 XOnlyPubKey::ComputeTapTweakHash(const uint256* merkle_root) const
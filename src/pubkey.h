@@ -12,6 +12,7 @@
 #include <span.h>
 #include <uint256.h>
 
+#include <array>
 #include <cstring>
 #include <optional>
 #include <vector>
@@ -299,6 +300,36 @@ public:
     SERIALIZE_METHODS(XOnlyPubKey, obj) { READWRITE(obj.m_keydata); }
 };
 
+/** Collects Schnorr signatures to verify them all at once. With a libsecp256k1
+ *  that has secp256k1_schnorrsig_verify_batch (see contrib/secp256k1), this is
+ *  faster than calling XOnlyPubKey::VerifySchnorr for each of them; otherwise
+ *  the signatures are verified one by one, and callers should check
+ *  IsSupported() rather than collecting them. */
+class BatchSchnorrVerifier
+{
+private:
+    struct Entry {
+        std::array<unsigned char, 64> sig;
+        XOnlyPubKey pubkey;
+        uint256 msg;
+    };
+    std::vector<Entry> m_entries;
+
+public:
+    /** Whether the library verifies a batch faster than one signature at a time. */
+    static bool IsSupported();
+
+    /** Add a signature to the batch. sigbytes must be exactly 64 bytes. */
+    void Add(const XOnlyPubKey& pubkey, const uint256& msg, Span<const unsigned char> sigbytes);
+
+    size_t size() const { return m_entries.size(); }
+    void clear() { m_entries.clear(); }
+
+    /** Verify all signatures in the batch. Returns false if any of them is
+     *  invalid, without telling which one. */
+    bool Verify() const;
+};
+
 /** An ElligatorSwift-encoded public key. */
 struct EllSwiftPubKey
 {
@@ -6,6 +6,7 @@
 #include <chainparams.h>
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
+#include <index/blockstatsindex.h>
 #include <index/coinstatsindex.h>
 #include <index/txindex.h>
 #include <interfaces/chain.h>
@@ -19,6 +20,7 @@
 #include <rpc/server_util.h>
 #include <rpc/util.h>
 #include <scheduler.h>
+#include <script/sigcache.h>
 #include <univalue.h>
 #include <util/any.h>
 #include <util/check.h>
@@ -110,6 +112,16 @@ static UniValue RPCLockedMemoryInfo()
     return obj;
 }
 
+static UniValue RPCSignatureCacheInfo()
+{
+    const SignatureCacheStats stats{GetSignatureCacheStats()};
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("shards", uint64_t(SIGCACHE_SHARDS));
+    obj.pushKV("hits", stats.hits);
+    obj.pushKV("misses", stats.misses);
+    return obj;
+}
+
 #ifdef HAVE_MALLOC_INFO
 static std::string RPCMallocInfo()
 {
@@ -154,6 +166,12 @@ static RPCHelpMan getmemoryinfo()
                                 {RPCResult::Type::NUM, "chunks_used", "Number allocated chunks"},
                                 {RPCResult::Type::NUM, "chunks_free", "Number unused chunks"},
                             }},
+                            {RPCResult::Type::OBJ, "sigcache", "Information about the signature cache",
+                            {
+                                {RPCResult::Type::NUM, "shards", "Number of separately locked parts of the cache"},
+                                {RPCResult::Type::NUM, "hits", "Number of signature lookups found in the cache since startup"},
+                                {RPCResult::Type::NUM, "misses", "Number of signature lookups not found in the cache since startup"},
+                            }},
                         }
                     },
                     RPCResult{"mode \"mallocinfo\"",
@@ -170,6 +188,7 @@ static RPCHelpMan getmemoryinfo()
     if (mode == "stats") {
         UniValue obj(UniValue::VOBJ);
         obj.pushKV("locked", RPCLockedMemoryInfo());
+        obj.pushKV("sigcache", RPCSignatureCacheInfo());
         return obj;
     } else if (mode == "mallocinfo") {
 #ifdef HAVE_MALLOC_INFO
@@ -384,6 +403,10 @@ static RPCHelpMan getindexinfo()
         result.pushKVs(SummaryToJSON(g_coin_stats_index->GetSummary(), index_name));
     }
 
+    if (g_block_stats_index) {
+        result.pushKVs(SummaryToJSON(g_block_stats_index->GetSummary(), index_name));
+    }
+
     ForEachBlockFilterIndex([&result, &index_name](const BlockFilterIndex& index) {
         result.pushKVs(SummaryToJSON(index.GetSummary(), index_name));
     });
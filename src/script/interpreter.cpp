@@ -47,13 +47,151 @@ bool CastToBool(const valtype& vch)
     return false;
 }
 
+namespace {
+
+/**
+ * Script stack that keeps the buffers of popped elements for reuse. Pushing
+ * copies into a spare buffer, which only allocates if the buffer is too
+ * small, so a stack that is used for script after script on one thread soon
+ * stops calling the allocator. Offers the part of the std::vector interface
+ * that EvalScript and VerifyScript use.
+ */
+class RecyclingStack
+{
+    //! Live elements in [0, m_size), spare buffers after that.
+    std::vector<valtype> m_elems;
+    size_t m_size{0};
+    //! Whether an element larger than MAX_SCRIPT_ELEMENT_SIZE was pushed since the last Trim().
+    bool m_oversized{false};
+
+public:
+    using iterator = std::vector<valtype>::iterator;
+    using const_iterator = std::vector<valtype>::const_iterator;
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    iterator begin() { return m_elems.begin(); }
+    iterator end() { return m_elems.begin() + m_size; }
+    const_iterator begin() const { return m_elems.begin(); }
+    const_iterator end() const { return m_elems.begin() + m_size; }
+
+    valtype& back() { return m_elems[m_size - 1]; }
+    valtype& at(size_t pos)
+    {
+        if (pos >= m_size) throw std::out_of_range("RecyclingStack::at");
+        return m_elems[pos];
+    }
+
+    void push_back(const valtype& elem)
+    {
+        if (elem.size() > MAX_SCRIPT_ELEMENT_SIZE) m_oversized = true;
+        if (m_size == m_elems.size()) {
+            // std::vector::push_back copes with elem being one of m_elems
+            m_elems.push_back(elem);
+        } else {
+            m_elems[m_size] = elem;
+        }
+        ++m_size;
+    }
+    void pop_back() { --m_size; }
+    void clear() { m_size = 0; }
+
+    /**
+     * Clear the stack and free the spare buffers that a script within the
+     * stack and element size limits would not need. Witness stacks are copied
+     * in before those limits are checked, and OP_SUCCESS skips them.
+     */
+    void Trim()
+    {
+        clear();
+        if (m_elems.size() > MAX_STACK_SIZE) {
+            m_elems.resize(MAX_STACK_SIZE);
+            m_elems.shrink_to_fit();
+        }
+        if (m_oversized) {
+            for (valtype& elem : m_elems) {
+                if (elem.capacity() > MAX_SCRIPT_ELEMENT_SIZE) valtype{}.swap(elem);
+            }
+            m_oversized = false;
+        }
+    }
+
+    void resize(size_t size)
+    {
+        while (m_size < size) push_back(valtype{});
+        m_size = size;
+    }
+
+    iterator erase(iterator first, iterator last)
+    {
+        // Move the erased buffers to the spare end, keeping their capacity
+        const auto pos{first - begin()};
+        std::rotate(first, last, end());
+        m_size -= last - first;
+        return begin() + pos;
+    }
+    iterator erase(iterator pos) { return erase(pos, pos + 1); }
+
+    iterator insert(iterator pos, const valtype& elem)
+    {
+        const auto index{pos - begin()};
+        push_back(elem);
+        std::rotate(begin() + index, end() - 1, end());
+        return begin() + index;
+    }
+
+    RecyclingStack() = default;
+    RecyclingStack(const RecyclingStack&) = delete;
+    RecyclingStack& operator=(const RecyclingStack&) = delete;
+
+    void assign(Span<const valtype> elems)
+    {
+        clear();
+        for (const valtype& elem : elems) push_back(elem);
+    }
+    void assign(const RecyclingStack& other) { assign(Span{other.m_elems}.first(other.m_size)); }
+
+    friend void swap(RecyclingStack& a, RecyclingStack& b) noexcept
+    {
+        a.m_elems.swap(b.m_elems);
+        std::swap(a.m_size, b.m_size);
+        std::swap(a.m_oversized, b.m_oversized);
+    }
+};
+
+/**
+ * The stacks used by VerifyScript, one set per thread. They keep their
+ * buffers from one script verification to the next, e.g. for each
+ * CScriptCheck. After each verification they are trimmed to at most
+ * MAX_STACK_SIZE buffers of MAX_SCRIPT_ELEMENT_SIZE bytes, so a large
+ * witness is not held on to. The altstack and the results of arithmetic
+ * opcodes are still allocated per use.
+ */
+struct ScriptStacks {
+    RecyclingStack main;
+    RecyclingStack p2sh_copy;
+    RecyclingStack witness;
+
+    void Trim()
+    {
+        main.Trim();
+        p2sh_copy.Trim();
+        witness.Trim();
+    }
+};
+thread_local ScriptStacks g_script_stacks;
+
+} // namespace
+
 /**
  * Script is a stack machine (like Forth) that evaluates a predicate
  * returning a bool indicating valid or not.  There are no loops.
  */
 #define stacktop(i)  (stack.at(stack.size()+(i)))
 #define altstacktop(i)  (altstack.at(altstack.size()+(i)))
-static inline void popstack(std::vector<valtype>& stack)
+template <typename Stack>
+static inline void popstack(Stack& stack)
 {
     if (stack.empty())
         throw std::runtime_error("popstack(): stack empty");
@@ -403,7 +541,8 @@ static bool EvalChecksig(const valtype& sig, const valtype& pubkey, CScript::con
     assert(false);
 }
 
-bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
+template <typename Stack>
+static bool EvalScriptImpl(Stack& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
 {
     static const CScriptNum bnZero(0);
     static const CScriptNum bnOne(1);
@@ -795,8 +934,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x -- x x)
                     if (stack.size() < 1)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-1);
-                    stack.push_back(vch);
+                    stack.push_back(stacktop(-1));
                 }
                 break;
 
@@ -1233,10 +1371,26 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
     return set_success(serror);
 }
 
+bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
+{
+    return EvalScriptImpl(stack, script, flags, checker, sigversion, execdata, serror);
+}
+
 bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror)
 {
     ScriptExecutionData execdata;
-    return EvalScript(stack, script, flags, checker, sigversion, execdata, serror);
+    return EvalScriptImpl(stack, script, flags, checker, sigversion, execdata, serror);
+}
+
+static bool EvalScript(RecyclingStack& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
+{
+    return EvalScriptImpl(stack, script, flags, checker, sigversion, execdata, serror);
+}
+
+static bool EvalScript(RecyclingStack& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror)
+{
+    ScriptExecutionData execdata;
+    return EvalScriptImpl(stack, script, flags, checker, sigversion, execdata, serror);
 }
 
 namespace {
@@ -1395,7 +1549,7 @@ uint256 GetSpentScriptsSHA256(const std::vector<CTxOut>& outputs_spent)
 } // namespace
 
 template <class T>
-void PrecomputedTransactionData::Init(const T& txTo, std::vector<CTxOut>&& spent_outputs, bool force)
+void PrecomputedTransactionData::Init(const T& txTo, std::vector<CTxOut>&& spent_outputs, bool force, bool defer_hashes)
 {
     assert(!m_spent_outputs_ready);
 
@@ -1427,23 +1581,32 @@ void PrecomputedTransactionData::Init(const T& txTo, std::vector<CTxOut>&& spent
         if (uses_bip341_taproot && uses_bip143_segwit) break; // No need to scan further if we already need all.
     }
 
-    if (uses_bip143_segwit || uses_bip341_taproot) {
+    m_bip143_segwit_pending = uses_bip143_segwit;
+    m_bip341_taproot_pending = uses_bip341_taproot;
+    if (!defer_hashes) ComputeHashes(txTo);
+}
+
+template <class T>
+void PrecomputedTransactionData::ComputeHashes(const T& txTo)
+{
+    if (m_bip143_segwit_pending || m_bip341_taproot_pending) {
         // Computations shared between both sighash schemes.
         m_prevouts_single_hash = GetPrevoutsSHA256(txTo);
         m_sequences_single_hash = GetSequencesSHA256(txTo);
         m_outputs_single_hash = GetOutputsSHA256(txTo);
     }
-    if (uses_bip143_segwit) {
+    if (m_bip143_segwit_pending) {
         hashPrevouts = SHA256Uint256(m_prevouts_single_hash);
         hashSequence = SHA256Uint256(m_sequences_single_hash);
         hashOutputs = SHA256Uint256(m_outputs_single_hash);
         m_bip143_segwit_ready = true;
     }
-    if (uses_bip341_taproot && m_spent_outputs_ready) {
+    if (m_bip341_taproot_pending && m_spent_outputs_ready) {
         m_spent_amounts_single_hash = GetSpentAmountsSHA256(m_spent_outputs);
         m_spent_scripts_single_hash = GetSpentScriptsSHA256(m_spent_outputs);
         m_bip341_taproot_ready = true;
     }
+    m_bip143_segwit_pending = m_bip341_taproot_pending = false;
 }
 
 template <class T>
@@ -1453,8 +1616,10 @@ PrecomputedTransactionData::PrecomputedTransactionData(const T& txTo)
 }
 
 // explicit instantiation
-template void PrecomputedTransactionData::Init(const CTransaction& txTo, std::vector<CTxOut>&& spent_outputs, bool force);
-template void PrecomputedTransactionData::Init(const CMutableTransaction& txTo, std::vector<CTxOut>&& spent_outputs, bool force);
+template void PrecomputedTransactionData::Init(const CTransaction& txTo, std::vector<CTxOut>&& spent_outputs, bool force, bool defer_hashes);
+template void PrecomputedTransactionData::Init(const CMutableTransaction& txTo, std::vector<CTxOut>&& spent_outputs, bool force, bool defer_hashes);
+template void PrecomputedTransactionData::ComputeHashes(const CTransaction& txTo);
+template void PrecomputedTransactionData::ComputeHashes(const CMutableTransaction& txTo);
 template PrecomputedTransactionData::PrecomputedTransactionData(const CTransaction& txTo);
 template PrecomputedTransactionData::PrecomputedTransactionData(const CMutableTransaction& txTo);
 
@@ -1787,7 +1952,8 @@ template class GenericTransactionSignatureChecker<CMutableTransaction>;
 
 static bool ExecuteWitnessScript(const Span<const valtype>& stack_span, const CScript& exec_script, unsigned int flags, SigVersion sigversion, const BaseSignatureChecker& checker, ScriptExecutionData& execdata, ScriptError* serror)
 {
-    std::vector<valtype> stack{stack_span.begin(), stack_span.end()};
+    RecyclingStack& stack{g_script_stacks.witness};
+    stack.assign(stack_span);
 
     if (sigversion == SigVersion::TAPSCRIPT) {
         // OP_SUCCESSx processing overrides everything, including stack element size limits
@@ -1870,6 +2036,45 @@ static bool VerifyTaprootCommitment(const std::vector<unsigned char>& control, c
     return q.CheckTapTweak(p, merkle_root, control[0] & 1);
 }
 
+/**
+ * Run a pay-to-pubkey-hash script (the P2PKH scriptPubKey, or the script
+ * implied by P2WPKH) on a stack of exactly [sig, pubkey] and require a true
+ * result, without the interpreter or its stack. Same outcome as EvalScript
+ * on OP_DUP OP_HASH160 <keyhash> OP_EQUALVERIFY OP_CHECKSIG.
+ */
+static bool VerifyPubKeyHash(const valtype& sig, const valtype& pubkey, const CScript& script_code, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror)
+{
+    // OP_DUP OP_HASH160 <keyhash> OP_EQUALVERIFY
+    const uint160 keyhash{Hash160(pubkey)};
+    if (!std::equal(keyhash.begin(), keyhash.end(), script_code.begin() + 3)) {
+        return set_error(serror, SCRIPT_ERR_EQUALVERIFY);
+    }
+    // OP_CHECKSIG
+    bool success = false;
+    if (!EvalChecksigPreTapscript(sig, pubkey, script_code.begin(), script_code.end(), flags, checker, sigversion, serror, success)) {
+        return false; // serror is set
+    }
+    if (!success) return set_error(serror, SCRIPT_ERR_EVAL_FALSE);
+    return set_success(serror);
+}
+
+/**
+ * Read a scriptSig consisting of exactly two data pushes, each of which
+ * EvalScript would accept under these flags. Anything else is left to the
+ * interpreter, so that it reports the error.
+ */
+static bool GetTwoPushes(const CScript& scriptSig, unsigned int flags, valtype& first, valtype& second)
+{
+    CScript::const_iterator pc = scriptSig.begin();
+    opcodetype opcode;
+    for (valtype* push : {&first, &second}) {
+        if (!scriptSig.GetOp(pc, opcode, *push) || opcode > OP_PUSHDATA4) return false;
+        if (push->size() > MAX_SCRIPT_ELEMENT_SIZE) return false;
+        if ((flags & SCRIPT_VERIFY_MINIMALDATA) && !CheckMinimalPush(*push, opcode)) return false;
+    }
+    return pc == scriptSig.end();
+}
+
 static bool VerifyWitnessProgram(const CScriptWitness& witness, int witversion, const std::vector<unsigned char>& program, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror, bool is_p2sh)
 {
     CScript exec_script; //!< Actually executed script (last stack item in P2WSH; implied P2PKH script in P2WPKH; leaf script in P2TR)
@@ -1896,7 +2101,11 @@ static bool VerifyWitnessProgram(const CScriptWitness& witness, int witversion,
                 return set_error(serror, SCRIPT_ERR_WITNESS_PROGRAM_MISMATCH); // 2 items in witness
             }
             exec_script << OP_DUP << OP_HASH160 << program << OP_EQUALVERIFY << OP_CHECKSIG;
-            return ExecuteWitnessScript(stack, exec_script, flags, SigVersion::WITNESS_V0, checker, execdata, serror);
+            // Same checks as ExecuteWitnessScript on this script, without copying the stack
+            for (const valtype& elem : stack) {
+                if (elem.size() > MAX_SCRIPT_ELEMENT_SIZE) return set_error(serror, SCRIPT_ERR_PUSH_SIZE);
+            }
+            return VerifyPubKeyHash(stack[0], stack[1], exec_script, flags, checker, SigVersion::WITNESS_V0, serror);
         } else {
             return set_error(serror, SCRIPT_ERR_WITNESS_PROGRAM_WRONG_LENGTH);
         }
@@ -1953,7 +2162,7 @@ static bool VerifyWitnessProgram(const CScriptWitness& witness, int witversion,
     // There is intentionally no return statement here, to be able to use "control reaches end of non-void function" warnings to detect gaps in the logic above.
 }
 
-bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror)
+static bool VerifyScriptImpl(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror)
 {
     static const CScriptWitness emptyWitness;
     if (witness == nullptr) {
@@ -1967,14 +2176,31 @@ bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const C
         return set_error(serror, SCRIPT_ERR_SIG_PUSHONLY);
     }
 
+    // P2PKH spends skip the interpreter. The scriptPubKey is neither P2SH nor
+    // a witness program, and leaves a clean stack, so only unexpected witness
+    // data remains to be checked afterwards.
+    if (scriptPubKey.IsPayToPubKeyHash()) {
+        valtype sig, pubkey;
+        if (GetTwoPushes(scriptSig, flags, sig, pubkey)) {
+            if (!VerifyPubKeyHash(sig, pubkey, scriptPubKey, flags, checker, SigVersion::BASE, serror)) return false;
+            if ((flags & SCRIPT_VERIFY_WITNESS) && !witness->IsNull()) {
+                return set_error(serror, SCRIPT_ERR_WITNESS_UNEXPECTED);
+            }
+            return set_success(serror);
+        }
+    }
+
     // scriptSig and scriptPubKey must be evaluated sequentially on the same stack
     // rather than being simply concatenated (see CVE-2010-5141)
-    std::vector<std::vector<unsigned char> > stack, stackCopy;
+    RecyclingStack& stack{g_script_stacks.main};
+    RecyclingStack& stackCopy{g_script_stacks.p2sh_copy};
+    stack.clear();
+    stackCopy.clear();
     if (!EvalScript(stack, scriptSig, flags, checker, SigVersion::BASE, serror))
         // serror is set
         return false;
     if (flags & SCRIPT_VERIFY_P2SH)
-        stackCopy = stack;
+        stackCopy.assign(stack);
     if (!EvalScript(stack, scriptPubKey, flags, checker, SigVersion::BASE, serror))
         // serror is set
         return false;
@@ -2074,6 +2300,13 @@ bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const C
     return set_success(serror);
 }
 
+bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror)
+{
+    const bool ret{VerifyScriptImpl(scriptSig, scriptPubKey, witness, flags, checker, serror)};
+    g_script_stacks.Trim();
+    return ret;
+}
+
 size_t static WitnessSigOps(int witversion, const std::vector<unsigned char>& witprogram, const CScriptWitness& witness)
 {
     if (witversion == 0) {
@@ -169,6 +169,10 @@ struct PrecomputedTransactionData
     //! Whether m_spent_outputs is initialized.
     bool m_spent_outputs_ready = false;
 
+    //! Whether ComputeHashes() still has to compute the BIP143 and BIP341 data.
+    bool m_bip143_segwit_pending = false;
+    bool m_bip341_taproot_pending = false;
+
     PrecomputedTransactionData() = default;
 
     /** Initialize this PrecomputedTransactionData with transaction data.
@@ -177,9 +181,15 @@ struct PrecomputedTransactionData
      * @param[in]   spent_outputs  The CTxOuts being spent, one for each tx.vin, in order.
      * @param[in]   force          Whether to precompute data for all optional features,
      *                             regardless of what is in the inputs (used at signing
-     *                             time, when the inputs aren't filled in yet). */
+     *                             time, when the inputs aren't filled in yet).
+     * @param[in]   defer_hashes   Whether to leave hashing the transaction to a later
+     *                             call to ComputeHashes(), e.g. on another thread. */
+    template <class T>
+    void Init(const T& tx, std::vector<CTxOut>&& spent_outputs, bool force = false, bool defer_hashes = false);
+
+    /** Compute the hashes that Init() deferred. Does nothing if there are none. */
     template <class T>
-    void Init(const T& tx, std::vector<CTxOut>&& spent_outputs, bool force = false);
+    void ComputeHashes(const T& tx);
 
     template <class T>
     explicit PrecomputedTransactionData(const T& tx);
@@ -6,6 +6,7 @@
 #include <script/sigcache.h>
 
 #include <common/system.h>
+#include <crypto/common.h>
 #include <logging.h>
 #include <pubkey.h>
 #include <random.h>
@@ -14,6 +15,8 @@
 #include <cuckoocache.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <mutex>
 #include <optional>
 #include <shared_mutex>
@@ -32,22 +35,50 @@ private:
     CSHA256 m_salted_hasher_ecdsa;
     CSHA256 m_salted_hasher_schnorr;
     typedef CuckooCache::cache<uint256, SignatureCacheHasher> map_type;
-    map_type setValid;
-    std::shared_mutex cs_sigcache;
+
+    /** An independently locked part of the cache. Each shard is a full cuckoo
+     *  cache with its own epochs, so threads looking up entries in different
+     *  shards never touch the same lock or counters. */
+    struct alignas(64) Shard {
+        map_type setValid;
+        std::shared_mutex cs_sigcache;
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+    };
+    std::array<Shard, SIGCACHE_SHARDS> m_shards;
+
+    Shard& GetShard(const uint256& entry)
+    {
+        // The cuckoo hashes are the raw words of the entry, so selecting the
+        // shard by a plain bit range would leave part of each shard's table
+        // unused by one of them. Mix the bits first.
+        const uint64_t mixed{ReadLE64(entry.begin()) * 0x9E3779B97F4A7C15ULL};
+        return m_shards[mixed >> (64 - SIGCACHE_SHARD_BITS)];
+    }
+
+    //! The salt of the entries, kept so that they can be persisted.
+    uint256 m_nonce;
 
 public:
     CSignatureCache()
     {
-        uint256 nonce = GetRandHash();
+        SetNonce(GetRandHash());
+    }
+
+    const uint256& GetNonce() const { return m_nonce; }
+
+    void SetNonce(const uint256& nonce)
+    {
+        m_nonce = nonce;
         // We want the nonce to be 64 bytes long to force the hasher to process
         // this chunk, which makes later hash computations more efficient. We
         // just write our 32-byte entropy, and then pad with 'E' for ECDSA and
         // 'S' for Schnorr (followed by 0 bytes).
         static constexpr unsigned char PADDING_ECDSA[32] = {'E'};
         static constexpr unsigned char PADDING_SCHNORR[32] = {'S'};
-        m_salted_hasher_ecdsa.Write(nonce.begin(), 32);
+        m_salted_hasher_ecdsa.Reset().Write(nonce.begin(), 32);
         m_salted_hasher_ecdsa.Write(PADDING_ECDSA, 32);
-        m_salted_hasher_schnorr.Write(nonce.begin(), 32);
+        m_salted_hasher_schnorr.Reset().Write(nonce.begin(), 32);
         m_salted_hasher_schnorr.Write(PADDING_SCHNORR, 32);
     }
 
@@ -68,18 +99,55 @@ public:
     bool
     Get(const uint256& entry, const bool erase)
     {
-        std::shared_lock<std::shared_mutex> lock(cs_sigcache);
-        return setValid.contains(entry, erase);
+        Shard& shard = GetShard(entry);
+        bool found;
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.cs_sigcache);
+            found = shard.setValid.contains(entry, erase);
+        }
+        (found ? shard.hits : shard.misses).fetch_add(1, std::memory_order_relaxed);
+        return found;
     }
 
     void Set(const uint256& entry)
     {
-        std::unique_lock<std::shared_mutex> lock(cs_sigcache);
-        setValid.insert(entry);
+        Shard& shard = GetShard(entry);
+        std::unique_lock<std::shared_mutex> lock(shard.cs_sigcache);
+        shard.setValid.insert(entry);
     }
+
     std::optional<std::pair<uint32_t, size_t>> setup_bytes(size_t n)
     {
-        return setValid.setup_bytes(n);
+        uint32_t num_elems{0};
+        size_t approx_size_bytes{0};
+        for (Shard& shard : m_shards) {
+            std::unique_lock<std::shared_mutex> lock(shard.cs_sigcache);
+            const auto setup_results = shard.setValid.setup_bytes(n / SIGCACHE_SHARDS);
+            if (!setup_results) return std::nullopt;
+            num_elems += setup_results->first;
+            approx_size_bytes += setup_results->second;
+        }
+        return std::make_pair(num_elems, approx_size_bytes);
+    }
+
+    std::vector<uint256> GetEntries()
+    {
+        std::vector<uint256> entries;
+        for (Shard& shard : m_shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.cs_sigcache);
+            shard.setValid.for_each_live([&](const uint256& entry) { entries.push_back(entry); });
+        }
+        return entries;
+    }
+
+    SignatureCacheStats GetStats() const
+    {
+        SignatureCacheStats stats;
+        for (const Shard& shard : m_shards) {
+            stats.hits += shard.hits.load(std::memory_order_relaxed);
+            stats.misses += shard.misses.load(std::memory_order_relaxed);
+        }
+        return stats;
     }
 };
 
@@ -100,11 +168,30 @@ bool InitSignatureCache(size_t max_size_bytes)
     if (!setup_results) return false;
 
     const auto [num_elems, approx_size_bytes] = *setup_results;
-    LogPrintf("Using %zu MiB out of %zu MiB requested for signature cache, able to store %zu elements\n",
-              approx_size_bytes >> 20, max_size_bytes >> 20, num_elems);
+    LogPrintf("Using %zu MiB out of %zu MiB requested for signature cache, able to store %zu elements in %zu shards\n",
+              approx_size_bytes >> 20, max_size_bytes >> 20, num_elems, SIGCACHE_SHARDS);
     return true;
 }
 
+uint256 GetSignatureCacheEntries(std::vector<uint256>& entries)
+{
+    entries = signatureCache.GetEntries();
+    return signatureCache.GetNonce();
+}
+
+void LoadSignatureCacheEntries(const uint256& nonce, const std::vector<uint256>& entries)
+{
+    signatureCache.SetNonce(nonce);
+    for (const uint256& entry : entries) {
+        signatureCache.Set(entry);
+    }
+}
+
+SignatureCacheStats GetSignatureCacheStats()
+{
+    return signatureCache.GetStats();
+}
+
 bool CachingTransactionSignatureChecker::VerifyECDSASignature(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash) const
 {
     uint256 entry;
@@ -123,6 +210,12 @@ bool CachingTransactionSignatureChecker::VerifySchnorrSignature(Span<const unsig
     uint256 entry;
     signatureCache.ComputeEntrySchnorr(entry, sighash, sig, pubkey);
     if (signatureCache.Get(entry, !store)) return true;
+    // A failing Schnorr signature always fails the script, so its verification
+    // can be deferred. Only verified signatures may be stored in the cache.
+    if (m_batch && !store) {
+        m_batch->Add(pubkey, sighash, sig);
+        return true;
+    }
     if (!TransactionSignatureChecker::VerifySchnorrSignature(sig, pubkey, sighash)) return false;
     if (store) signatureCache.Set(entry);
     return true;
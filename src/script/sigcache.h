@@ -8,8 +8,10 @@
 
 #include <script/interpreter.h>
 #include <span.h>
+#include <uint256.h>
 #include <util/hasher.h>
 
+#include <cstdint>
 #include <optional>
 #include <vector>
 
@@ -18,15 +20,23 @@
 // more (~32.25 MiB)
 static constexpr size_t DEFAULT_MAX_SIG_CACHE_BYTES{32 << 20};
 
+//! The signature cache is split into 2^SIGCACHE_SHARD_BITS separately locked shards.
+static constexpr int SIGCACHE_SHARD_BITS{4};
+static constexpr size_t SIGCACHE_SHARDS{size_t{1} << SIGCACHE_SHARD_BITS};
+
+class BatchSchnorrVerifier;
 class CPubKey;
 
 class CachingTransactionSignatureChecker : public TransactionSignatureChecker
 {
 private:
     bool store;
+    //! If set (and not storing in the cache), Schnorr signatures are added to
+    //! this batch and assumed valid; the caller must verify the batch.
+    BatchSchnorrVerifier* m_batch;
 
 public:
-    CachingTransactionSignatureChecker(const CTransaction* txToIn, unsigned int nInIn, const CAmount& amountIn, bool storeIn, PrecomputedTransactionData& txdataIn) : TransactionSignatureChecker(txToIn, nInIn, amountIn, txdataIn, MissingDataBehavior::ASSERT_FAIL), store(storeIn) {}
+    CachingTransactionSignatureChecker(const CTransaction* txToIn, unsigned int nInIn, const CAmount& amountIn, bool storeIn, PrecomputedTransactionData& txdataIn, BatchSchnorrVerifier* batch = nullptr) : TransactionSignatureChecker(txToIn, nInIn, amountIn, txdataIn, MissingDataBehavior::ASSERT_FAIL), store(storeIn), m_batch(batch) {}
 
     bool VerifyECDSASignature(const std::vector<unsigned char>& vchSig, const CPubKey& vchPubKey, const uint256& sighash) const override;
     bool VerifySchnorrSignature(Span<const unsigned char> sig, const XOnlyPubKey& pubkey, const uint256& sighash) const override;
@@ -34,4 +44,20 @@ public:
 
 [[nodiscard]] bool InitSignatureCache(size_t max_size_bytes);
 
+/** Copy the valid entries of the signature cache.
+ *  @returns the salt the entries were computed with */
+uint256 GetSignatureCacheEntries(std::vector<uint256>& entries);
+
+/** Switch the signature cache to the given salt and insert entries computed
+ *  with it. Only to be called at startup, before the cache is used. */
+void LoadSignatureCacheEntries(const uint256& nonce, const std::vector<uint256>& entries);
+
+struct SignatureCacheStats {
+    uint64_t hits{0};
+    uint64_t misses{0};
+};
+
+/** Lookups in the signature cache since startup, summed over all shards. */
+SignatureCacheStats GetSignatureCacheStats();
+
 #endif // OCVCOIN_SCRIPT_SIGCACHE_H
@@ -182,6 +182,14 @@ public:
         memcpy(dst.data(), m_data.data(), dst.size());
         m_data = m_data.subspan(dst.size());
     }
+
+    void ignore(size_t n)
+    {
+        if (n > m_data.size()) {
+            throw std::ios_base::failure("SpanReader::ignore(): end of data");
+        }
+        m_data = m_data.subspan(n);
+    }
 };
 
 /** Double ended buffer combining vector and stream-like interfaces.
@@ -578,9 +586,9 @@ private:
 
     //! read data from the source to fill the buffer
     bool Fill() {
-        unsigned int pos = nSrcPos % vchBuf.size();
-        unsigned int readNow = vchBuf.size() - pos;
-        unsigned int nAvail = vchBuf.size() - (nSrcPos - m_read_pos) - nRewind;
+        size_t pos{static_cast<size_t>(nSrcPos % vchBuf.size())};
+        size_t readNow{vchBuf.size() - pos};
+        size_t nAvail{static_cast<size_t>(vchBuf.size() - (nSrcPos - m_read_pos) - nRewind)};
         if (nAvail < readNow)
             readNow = nAvail;
         if (readNow == 0)
@@ -648,6 +656,9 @@ public:
         while (m_read_pos < file_pos) AdvanceStream(file_pos - m_read_pos);
     }
 
+    //! skip a number of bytes
+    void ignore(size_t n) { SkipTo(m_read_pos + n); }
+
     //! return the current reading position
     uint64_t GetPos() const {
         return m_read_pos;
@@ -698,15 +709,46 @@ public:
                 Fill();
             }
             const size_t len{std::min<size_t>(vchBuf.size() - buf_offset, nSrcPos - m_read_pos)};
-            const auto it_start{vchBuf.begin() + buf_offset};
-            const auto it_find{std::find(it_start, it_start + len, byte)};
-            const size_t inc{size_t(std::distance(it_start, it_find))};
+            // memchr is vectorized by the C library, unlike std::find on std::byte.
+            const std::byte* start{vchBuf.data() + buf_offset};
+            const void* found{memchr(start, std::to_integer<unsigned char>(byte), len)};
+            const size_t inc{found ? size_t(static_cast<const std::byte*>(found) - start) : len};
             m_read_pos += inc;
             if (inc < len) break;
             buf_offset += inc;
             if (buf_offset >= vchBuf.size()) buf_offset = 0;
         }
     }
+
+    //! search for a given sequence of bytes in the stream, and remain positioned
+    //! on its first byte. Throws like FindByte if end-of-file is reached first.
+    //! If the buffer beyond the rewind limit is too small to hold the sequence,
+    //! this may stop on a partial match.
+    void FindBytes(Span<const std::byte> bytes)
+    {
+        assert(!bytes.empty());
+        while (true) {
+            FindByte(bytes[0]);
+            if (StartsWith(bytes.subspan(1), /*offset=*/1)) return;
+            ++m_read_pos;
+        }
+    }
+
+private:
+    //! check whether the stream continues with the given bytes after skipping
+    //! offset bytes, without moving the read position. Only the bytes that fit
+    //! into the buffer are compared.
+    bool StartsWith(Span<const std::byte> bytes, size_t offset)
+    {
+        while (nSrcPos - m_read_pos < offset + bytes.size() && Fill()) {}
+        const size_t available{std::min<size_t>(bytes.size(), nSrcPos - m_read_pos - offset)};
+        size_t buf_offset{size_t((m_read_pos + offset) % uint64_t(vchBuf.size()))};
+        for (const std::byte b : bytes.first(available)) {
+            if (vchBuf[buf_offset] != b) return false;
+            if (++buf_offset == vchBuf.size()) buf_offset = 0;
+        }
+        return true;
+    }
 };
 
 #endif // OCVCOIN_STREAMS_H
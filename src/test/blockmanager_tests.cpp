@@ -4,14 +4,23 @@
 
 #include <chainparams.h>
 #include <clientversion.h>
+#include <node/block_prefetcher.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <node/kernel_notifications.h>
 #include <script/solver.h>
 #include <primitives/block.h>
+#include <streams.h>
+#include <undo.h>
 #include <util/chaintype.h>
+#include <util/time.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <set>
+#include <vector>
+
 #include <boost/test/unit_test.hpp>
 #include <test/util/logging.h>
 #include <test/util/setup_common.h>
@@ -93,6 +102,141 @@ BOOST_FIXTURE_TEST_CASE(blockmanager_scan_unlink_already_pruned_files, TestChain
     BOOST_CHECK(!blockman.OpenBlockFile(new_pos, true).IsNull());
 }
 
+BOOST_FIXTURE_TEST_CASE(blockmanager_scan_block_file, TestChain100Setup)
+{
+    auto& chainman{*Assert(m_node.chainman)};
+    const FlatFilePos pos(0, 0);
+    CAutoFile file{chainman.m_blockman.OpenBlockFile(pos, true)};
+    BOOST_REQUIRE(!file.IsNull());
+    std::vector<BlockFileRecord> records{chainman.ScanBlockFile(file, pos.nFile)};
+
+    // The blocks were written in chain order, so the records follow the active chain
+    {
+        LOCK(chainman.GetMutex());
+        BOOST_REQUIRE_EQUAL(records.size(), static_cast<size_t>(chainman.ActiveHeight() + 1));
+        for (int height{0}; height <= chainman.ActiveHeight(); ++height) {
+            const CBlockIndex* pindex{chainman.ActiveChain()[height]};
+            BOOST_CHECK_EQUAL(records[height].hash, pindex->GetBlockHash());
+            BOOST_CHECK_EQUAL(records[height].block->GetHash(), pindex->GetBlockHash());
+            BOOST_CHECK(records[height].pos == pindex->GetBlockPos());
+        }
+    }
+
+    // Processing blocks that are already known leaves the chain as it is
+    const CBlockIndex* tip{WITH_LOCK(chainman.GetMutex(), return chainman.ActiveTip())};
+    std::multimap<uint256, FlatFilePos> blocks_with_unknown_parent;
+    chainman.LoadBlockFileRecords(std::move(records), blocks_with_unknown_parent);
+    BOOST_CHECK(blocks_with_unknown_parent.empty());
+    BOOST_CHECK_EQUAL(WITH_LOCK(chainman.GetMutex(), return chainman.ActiveTip()), tip);
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_undo_cache, TestChain100Setup)
+{
+    auto& chainman{*Assert(m_node.chainman)};
+    auto& blockman{chainman.m_blockman};
+    const CBlockIndex* tip{WITH_LOCK(chainman.GetMutex(), return chainman.ActiveTip())};
+
+    // A read is cached, and served from the cache after that
+    CBlockUndo undo;
+    BOOST_REQUIRE(blockman.UndoReadFromDisk(undo, *tip));
+    BOOST_CHECK(blockman.m_undo_cache.Contains(tip->GetBlockHash()));
+    BOOST_CHECK_EQUAL(blockman.m_undo_cache.Usage(), node::BlockUndoUsage(undo));
+    CBlockUndo cached_undo;
+    BOOST_REQUIRE(blockman.UndoReadFromDisk(cached_undo, *tip));
+    BOOST_CHECK_EQUAL(cached_undo.vtxundo.size(), undo.vtxundo.size());
+
+    // Prefetching reads the blocks that are not cached yet, and the genesis
+    // block has no undo data
+    std::vector<const CBlockIndex*> blocks;
+    for (const CBlockIndex* pindex{tip}; pindex; pindex = pindex->pprev) {
+        blocks.push_back(pindex);
+    }
+    blockman.PrefetchUndo(blocks);
+    for (const CBlockIndex* pindex : blocks) {
+        BOOST_CHECK_EQUAL(blockman.m_undo_cache.Contains(pindex->GetBlockHash()), pindex->pprev != nullptr);
+    }
+
+    // Prefetching stops once the undo data read fills the cache, keeping the
+    // blocks needed first
+    KernelNotifications notifications{m_node.exit_status};
+    const BlockManager::Options small_opts{
+        .chainparams = chainman.GetParams(),
+        .undo_cache_bytes = 3 * node::BlockUndoUsage(undo),
+        .blocks_dir = m_args.GetBlocksDirPath(),
+        .notifications = notifications,
+    };
+    const BlockManager small_blockman{m_node.kernel->interrupt, small_opts};
+    small_blockman.PrefetchUndo(blocks);
+    for (size_t i{0}; i < 3; ++i) {
+        BOOST_CHECK(small_blockman.m_undo_cache.Contains(blocks[i]->GetBlockHash()));
+    }
+    BOOST_CHECK_LE(small_blockman.m_undo_cache.Usage(), 3 * node::BlockUndoUsage(undo));
+
+    // Entries are evicted to stay within the memory limit, least recently used first
+    node::BlockUndoCache small_cache{2 * node::BlockUndoUsage(undo)};
+    for (const CBlockIndex* pindex : std::vector<const CBlockIndex*>{tip, tip->pprev, tip->pprev->pprev}) {
+        BOOST_REQUIRE(blockman.UndoReadFromDisk(undo, *pindex));
+        small_cache.Insert(pindex->GetBlockHash(), std::make_shared<const CBlockUndo>(undo));
+    }
+    BOOST_CHECK(!small_cache.Contains(tip->GetBlockHash()));
+    BOOST_CHECK(small_cache.Contains(tip->pprev->GetBlockHash()));
+    BOOST_CHECK(small_cache.Contains(tip->pprev->pprev->GetBlockHash()));
+    BOOST_CHECK_LE(small_cache.Usage(), 2 * node::BlockUndoUsage(undo));
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_defrag_block_files, TestChain100Setup)
+{
+    auto& chainman{*Assert(m_node.chainman)};
+    auto& blockman{chainman.m_blockman};
+    const auto tip_pos{[&] { return WITH_LOCK(chainman.GetMutex(), return chainman.ActiveTip()->GetBlockPos()); }};
+
+    // Block files that are in chain order already are kept
+    const FlatFilePos in_order_pos{tip_pos()};
+    node::DefragBlockFiles(chainman);
+    BOOST_CHECK(!fs::exists(blockman.GetBlockPosFilename(FlatFilePos(1, 0))));
+    BOOST_CHECK(tip_pos() == in_order_pos);
+
+    // A block that is not in the active chain puts the file out of order
+    CreateAndProcessBlock({}, CScript() << OP_TRUE);
+    BlockValidationState state;
+    BOOST_REQUIRE(chainman.ActiveChainstate().InvalidateBlock(state, WITH_LOCK(chainman.GetMutex(), return chainman.ActiveTip())));
+    node::DefragBlockFiles(chainman);
+
+    // All blocks were rewritten in chain order, followed by the stale block,
+    // into files that start at zero again
+    BOOST_CHECK(fs::exists(blockman.GetBlockPosFilename(FlatFilePos(0, 0))));
+    BOOST_CHECK(!fs::exists(blockman.GetBlockPosFilename(FlatFilePos(1, 0))));
+    WAIT_LOCK(chainman.GetMutex(), lock);
+    BOOST_CHECK_EQUAL(blockman.GetBlockFileInfo(0)->nBlocks, 102U);
+    BOOST_CHECK_THROW(blockman.GetBlockFileInfo(1), std::out_of_range);
+    const CBlockIndex* prev{nullptr};
+    for (const CBlockIndex* pindex{chainman.ActiveChain().Genesis()}; pindex; pindex = chainman.ActiveChain().Next(pindex)) {
+        BOOST_CHECK_EQUAL(pindex->nFile, 0);
+        if (prev) BOOST_CHECK_GT(pindex->nDataPos, prev->nDataPos);
+        CBlock block;
+        BOOST_REQUIRE(blockman.ReadBlockFromDisk(block, *pindex));
+        BOOST_CHECK_EQUAL(block.GetHash(), pindex->GetBlockHash());
+        prev = pindex;
+    }
+
+    // New blocks go to the end of the last file
+    {
+        REVERSE_LOCK(lock);
+        CreateAndProcessBlock({}, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+    }
+    BOOST_CHECK_EQUAL(chainman.ActiveTip()->nFile, 0);
+    BOOST_CHECK_GT(chainman.ActiveTip()->nDataPos, prev->nDataPos);
+
+    // Defragmenting is only done once
+    const FlatFilePos defragmented_pos{chainman.ActiveTip()->GetBlockPos()};
+    {
+        REVERSE_LOCK(lock);
+        node::DefragBlockFiles(chainman);
+    }
+    BOOST_CHECK(!fs::exists(blockman.GetBlockPosFilename(FlatFilePos(1, 0))));
+    BOOST_CHECK(chainman.ActiveTip()->GetBlockPos() == defragmented_pos);
+}
+
 BOOST_FIXTURE_TEST_CASE(blockmanager_block_data_availability, TestChain100Setup)
 {
     // The goal of the function is to return the first not pruned block in the range [upper_block, lower_block].
@@ -201,4 +345,247 @@ BOOST_AUTO_TEST_CASE(blockmanager_flush_block_file)
     BOOST_CHECK_EQUAL(read_block.nVersion, 2);
 }
 
+BOOST_AUTO_TEST_CASE(blockmanager_mapped_block_reads)
+{
+    KernelNotifications notifications{m_node.exit_status};
+    node::BlockManager::Options blockman_opts{
+        .chainparams = Params(),
+        .blocks_dir = m_args.GetBlocksDirPath(),
+        .notifications = notifications,
+    };
+    BlockManager blockman{m_node.kernel->interrupt, blockman_opts};
+    blockman_opts.blockfile_maps = 0;
+    BlockManager unmapped_blockman{m_node.kernel->interrupt, blockman_opts};
+
+    const CBlock& genesis{Params().GenesisBlock()};
+    const FlatFilePos pos{blockman.SaveBlockToDisk(genesis, /*nHeight=*/0, /*dbp=*/nullptr)};
+
+    // Without mappings there is no view, but regular reads still work
+    BOOST_CHECK(!unmapped_blockman.ReadRawBlockView(pos));
+    std::vector<uint8_t> raw_block;
+    BOOST_REQUIRE(unmapped_blockman.ReadRawBlockFromDisk(raw_block, pos));
+
+    const auto view{blockman.ReadRawBlockView(pos)};
+    BOOST_REQUIRE(view);
+    const auto view_bytes{UCharSpanCast(view->data)};
+    BOOST_CHECK(std::equal(view_bytes.begin(), view_bytes.end(), raw_block.begin(), raw_block.end()));
+
+    // A block appended after the file was mapped is found as well
+    const FlatFilePos pos2{blockman.SaveBlockToDisk(genesis, /*nHeight=*/1, /*dbp=*/nullptr)};
+    CBlock read_block;
+    BOOST_CHECK(blockman.ReadBlockFromDisk(read_block, pos2));
+    BOOST_CHECK_EQUAL(read_block.GetHash(), genesis.GetHash());
+
+    // A position that does not point at a block is not served from the mapping
+    BOOST_CHECK(!blockman.ReadRawBlockView(FlatFilePos{pos.nFile, pos.nPos + 1}));
+
+    // Views keep their mapping alive after the file is pruned
+    blockman.UnlinkPrunedFiles({pos.nFile});
+    BOOST_CHECK(std::equal(view_bytes.begin(), view_bytes.end(), raw_block.begin(), raw_block.end()));
+    BOOST_CHECK(!blockman.ReadRawBlockView(pos));
+}
+
+BOOST_AUTO_TEST_CASE(blockmanager_block_compression)
+{
+    KernelNotifications notifications{m_node.exit_status};
+    node::BlockManager::Options blockman_opts{
+        .chainparams = Params(),
+        .block_compression = true,
+        .blocks_dir = m_args.GetBlocksDirPath(),
+        .notifications = notifications,
+    };
+    BlockManager blockman{m_node.kernel->interrupt, blockman_opts};
+
+    const CBlock& genesis{Params().GenesisBlock()};
+    const FlatFilePos pos{blockman.SaveBlockToDisk(genesis, /*nHeight=*/0, /*dbp=*/nullptr)};
+    BOOST_CHECK_LT(blockman.CalculateCurrentUsage(), ::GetSerializeSize(genesis, CLIENT_VERSION) + BLOCK_SERIALIZATION_HEADER_SIZE);
+
+    // The compressed record can not be viewed in place, but reads decode it
+    BOOST_CHECK(!blockman.ReadRawBlockView(pos));
+    CBlock read_block;
+    BOOST_CHECK(blockman.ReadBlockFromDisk(read_block, pos));
+    BOOST_CHECK_EQUAL(read_block.GetHash(), genesis.GetHash());
+    std::vector<uint8_t> raw_block;
+    BOOST_REQUIRE(blockman.ReadRawBlockFromDisk(raw_block, pos));
+    std::vector<uint8_t> expected;
+    CVectorWriter{CLIENT_VERSION, expected, 0, genesis};
+    BOOST_CHECK(raw_block == expected);
+
+    // Same without block file mappings
+    blockman_opts.blockfile_maps = 0;
+    BlockManager unmapped_blockman{m_node.kernel->interrupt, blockman_opts};
+    BOOST_CHECK(unmapped_blockman.ReadBlockFromDisk(read_block, pos));
+    BOOST_CHECK_EQUAL(read_block.GetHash(), genesis.GetHash());
+    std::vector<uint8_t> unmapped_raw_block;
+    BOOST_REQUIRE(unmapped_blockman.ReadRawBlockFromDisk(unmapped_raw_block, pos));
+    BOOST_CHECK(unmapped_raw_block == raw_block);
+}
+
+BOOST_AUTO_TEST_CASE(blockmanager_async_writes)
+{
+    KernelNotifications notifications{m_node.exit_status};
+    node::BlockManager::Options blockman_opts{
+        .chainparams = Params(),
+        .async_writes = true,
+        .blocks_dir = m_args.GetBlocksDirPath(),
+        .notifications = notifications,
+    };
+    BlockManager blockman{m_node.kernel->interrupt, blockman_opts};
+
+    // Positions are handed out before the writes reach the disk
+    const CBlock& genesis{Params().GenesisBlock()};
+    std::vector<FlatFilePos> positions;
+    for (int i{0}; i < 10; ++i) {
+        positions.push_back(blockman.SaveBlockToDisk(genesis, /*nHeight=*/i, /*dbp=*/nullptr));
+        BOOST_CHECK_EQUAL(positions.back().nPos, BLOCK_SERIALIZATION_HEADER_SIZE + i * (::GetSerializeSize(genesis, CLIENT_VERSION) + BLOCK_SERIALIZATION_HEADER_SIZE));
+    }
+
+    // Reads wait for the queued writes to the file
+    std::vector<uint8_t> expected;
+    CVectorWriter{CLIENT_VERSION, expected, 0, genesis};
+    for (const FlatFilePos& pos : positions) {
+        CBlock read_block;
+        BOOST_CHECK(blockman.ReadBlockFromDisk(read_block, pos));
+        BOOST_CHECK_EQUAL(read_block.GetHash(), genesis.GetHash());
+        std::vector<uint8_t> raw_block;
+        BOOST_REQUIRE(blockman.ReadRawBlockFromDisk(raw_block, pos));
+        BOOST_CHECK(raw_block == expected);
+    }
+
+    // The queued writes are finished when the block manager is destroyed
+    auto async_blockman{std::make_unique<BlockManager>(m_node.kernel->interrupt, blockman_opts)};
+    const FlatFilePos last_pos{async_blockman->SaveBlockToDisk(genesis, /*nHeight=*/0, /*dbp=*/nullptr)};
+    async_blockman.reset();
+    blockman_opts.async_writes = false;
+    blockman_opts.blockfile_maps = 0;
+    BlockManager sync_blockman{m_node.kernel->interrupt, blockman_opts};
+    CBlock read_block;
+    BOOST_CHECK(sync_blockman.ReadBlockFromDisk(read_block, last_pos));
+    BOOST_CHECK_EQUAL(read_block.GetHash(), genesis.GetHash());
+}
+
+BOOST_AUTO_TEST_CASE(blockfile_writer_failure)
+{
+    int errors{0};
+    node::BlockFileWriter writer{/*max_pending_bytes=*/1024, [&] { ++errors; }};
+    writer.Enqueue([] { return true; });
+    writer.WaitForAll();
+    BOOST_CHECK(!writer.Failed());
+
+    // A failure is reported once and stays set after later writes succeed
+    writer.Enqueue([] { return false; });
+    writer.Enqueue([] { return true; });
+    writer.WaitForAll();
+    BOOST_CHECK(writer.Failed());
+    BOOST_CHECK_EQUAL(errors, 1);
+}
+
+BOOST_AUTO_TEST_CASE(blockfile_pruner)
+{
+    std::vector<int> unlinked;
+    {
+        node::BlockFilePruner pruner{[&](int file_num) { unlinked.push_back(file_num); }, std::chrono::milliseconds{0}};
+        pruner.Enqueue({3, 1, 2});
+        pruner.WaitForAll();
+        BOOST_CHECK_EQUAL(pruner.Pending(), 0U);
+    }
+    BOOST_CHECK(unlinked == std::vector<int>({1, 2, 3}));
+
+    // Files not deleted yet at shutdown are left alone
+    unlinked.clear();
+    {
+        node::BlockFilePruner pruner{[&](int file_num) { unlinked.push_back(file_num); }, std::chrono::hours{1}};
+        pruner.Enqueue({1, 2});
+        while (pruner.Pending() > 1) {
+            UninterruptibleSleep(std::chrono::milliseconds{1});
+        }
+    }
+    BOOST_CHECK(unlinked == std::vector<int>({1}));
+}
+
+
+BOOST_AUTO_TEST_CASE(block_prefetcher)
+{
+    // Loads only finish once the test releases them, so it knows which blocks
+    // are queued, being loaded or loaded at every step.
+    Mutex gate_mutex;
+    std::condition_variable gate_cv;
+    std::set<int> started, released;
+    const auto wait_started{[&](int n) {
+        WAIT_LOCK(gate_mutex, lock);
+        gate_cv.wait(lock, [&] { return started.count(n) > 0; });
+    }};
+    const auto release{[&](int n) {
+        WITH_LOCK(gate_mutex, released.insert(n));
+        gate_cv.notify_all();
+    }};
+
+    // Blocks are told apart by their nVersion, also used as the file
+    // position; the block at position 0 fails to load.
+    const auto load{[&](const CBlockIndex& index, const FlatFilePos& pos) -> std::shared_ptr<const CBlock> {
+        {
+            WAIT_LOCK(gate_mutex, lock);
+            started.insert(pos.nPos);
+            gate_cv.notify_all();
+            gate_cv.wait(lock, [&] { return released.count(pos.nPos) > 0; });
+        }
+        if (pos.nPos == 0) return nullptr;
+        auto block{std::make_shared<CBlock>()};
+        block->nVersion = index.nVersion;
+        return block;
+    }};
+    std::vector<uint256> hashes(8);
+    std::vector<CBlockIndex> indexes(8);
+    for (int n = 0; n < 8; ++n) {
+        hashes[n] = uint256{uint8_t(n)};
+        indexes[n].phashBlock = &hashes[n];
+        indexes[n].nVersion = n;
+    }
+    const auto entry{[&](int n) { return std::make_pair(&indexes[n], FlatFilePos{0, unsigned(n)}); }};
+
+    node::BlockPrefetcher prefetcher{load, /*num_threads=*/2, /*max_blocks=*/3};
+    BOOST_CHECK(!prefetcher.Take(hashes[1]));
+
+    // Only the first max_blocks are queued, the threads pick up the first two
+    prefetcher.Prefetch({entry(1), entry(2), entry(3), entry(4)});
+    BOOST_CHECK_EQUAL(prefetcher.Size(), 3U);
+    wait_started(1);
+    wait_started(2);
+    release(1);
+    BOOST_CHECK_EQUAL(prefetcher.Take(hashes[1])->nVersion, 1);
+    // Taking a block queues the next one
+    BOOST_CHECK_EQUAL(prefetcher.Size(), 3U);
+
+    // Blocks no longer about to be connected are dropped, also while loading
+    prefetcher.Prefetch({entry(3), entry(4)});
+    BOOST_CHECK_EQUAL(prefetcher.Size(), 2U);
+    BOOST_CHECK(!prefetcher.Take(hashes[2]));
+    wait_started(3);
+    release(2);
+    wait_started(4);
+    release(3);
+    release(4);
+    BOOST_CHECK_EQUAL(prefetcher.Take(hashes[4])->nVersion, 4);
+    BOOST_CHECK_EQUAL(prefetcher.Take(hashes[3])->nVersion, 3);
+    BOOST_CHECK_EQUAL(prefetcher.Size(), 0U);
+
+    // A block not picked up by a thread yet is left to the caller
+    prefetcher.Prefetch({entry(5), entry(6), entry(7)});
+    wait_started(5);
+    wait_started(6);
+    BOOST_CHECK(!prefetcher.Take(hashes[7]));
+    BOOST_CHECK_EQUAL(prefetcher.Size(), 2U);
+    release(5);
+    release(6);
+    BOOST_CHECK_EQUAL(prefetcher.Take(hashes[5])->nVersion, 5);
+    BOOST_CHECK_EQUAL(prefetcher.Take(hashes[6])->nVersion, 6);
+
+    // Blocks that failed to load are not handed over
+    prefetcher.Prefetch({entry(0)});
+    wait_started(0);
+    release(0);
+    BOOST_CHECK(!prefetcher.Take(hashes[0]));
+    BOOST_CHECK_EQUAL(prefetcher.Size(), 0U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+// Copyright (c) 2026 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <index/blockstatsindex.h>
+#include <interfaces/chain.h>
+#include <node/blockstorage.h>
+#include <test/util/index.h>
+#include <test/util/setup_common.h>
+#include <undo.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(blockstatsindex_tests)
+
+//! Check the stats stored by the index against the ones computed from the block and undo data on disk.
+static void CheckStatsFromDisk(ChainstateManager& chainman, const BlockStatsIndex& index, const CBlockIndex& block_index)
+{
+    const auto stats{index.LookUpStats(block_index)};
+    BOOST_REQUIRE(stats);
+    CBlock block;
+    BOOST_REQUIRE(chainman.m_blockman.ReadBlockFromDisk(block, block_index));
+    CBlockUndo block_undo;
+    BOOST_REQUIRE(block_index.nHeight == 0 || chainman.m_blockman.UndoReadFromDisk(block_undo, block_index));
+    const BlockStats expected{ComputeBlockStats(block, block_undo, block_index)};
+
+    BOOST_CHECK_EQUAL(stats->txs, expected.txs);
+    BOOST_CHECK_EQUAL(stats->ins, expected.ins);
+    BOOST_CHECK_EQUAL(stats->outs, expected.outs);
+    BOOST_CHECK_EQUAL(stats->total_out, expected.total_out);
+    BOOST_CHECK_EQUAL(stats->total_size, expected.total_size);
+    BOOST_CHECK_EQUAL(stats->total_weight, expected.total_weight);
+    BOOST_CHECK_EQUAL(stats->swtxs, expected.swtxs);
+    BOOST_CHECK_EQUAL(stats->swtotal_size, expected.swtotal_size);
+    BOOST_CHECK_EQUAL(stats->swtotal_weight, expected.swtotal_weight);
+    BOOST_CHECK_EQUAL(stats->totalfee, expected.totalfee);
+    BOOST_CHECK_EQUAL(stats->minfee, expected.minfee);
+    BOOST_CHECK_EQUAL(stats->maxfee, expected.maxfee);
+    BOOST_CHECK_EQUAL(stats->medianfee, expected.medianfee);
+    BOOST_CHECK_EQUAL(stats->minfeerate, expected.minfeerate);
+    BOOST_CHECK_EQUAL(stats->maxfeerate, expected.maxfeerate);
+    BOOST_CHECK_EQUAL_COLLECTIONS(stats->feerate_percentiles.begin(), stats->feerate_percentiles.end(),
+                                  expected.feerate_percentiles.begin(), expected.feerate_percentiles.end());
+    BOOST_CHECK_EQUAL(stats->mintxsize, expected.mintxsize);
+    BOOST_CHECK_EQUAL(stats->maxtxsize, expected.maxtxsize);
+    BOOST_CHECK_EQUAL(stats->mediantxsize, expected.mediantxsize);
+    BOOST_CHECK_EQUAL(stats->utxos, expected.utxos);
+    BOOST_CHECK_EQUAL(stats->utxo_size_inc, expected.utxo_size_inc);
+    BOOST_CHECK_EQUAL(stats->utxo_size_inc_actual, expected.utxo_size_inc_actual);
+}
+
+BOOST_FIXTURE_TEST_CASE(blockstatsindex_initial_sync, TestChain100Setup)
+{
+    BlockStatsIndex block_stats_index{interfaces::MakeChain(m_node), 1 << 20, true};
+    BOOST_REQUIRE(block_stats_index.Init());
+
+    const CBlockIndex* block_index{WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip())};
+
+    // BlockStatsIndex should not be found before it is started.
+    BOOST_CHECK(!block_stats_index.LookUpStats(*block_index));
+
+    BOOST_REQUIRE(block_stats_index.StartBackgroundSync());
+    IndexWaitSynced(block_stats_index);
+
+    // The stats of every block are the ones computed from disk
+    for (const CBlockIndex* pindex{block_index}; pindex; pindex = pindex->pprev) {
+        CheckStatsFromDisk(*m_node.chainman, block_stats_index, *pindex);
+    }
+
+    // A block with a transaction spending a coinbase output
+    const CScript script_pub_key{CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG};
+    CMutableTransaction tx{CreateValidMempoolTransaction(m_coinbase_txns[0], /*input_vout=*/0, /*input_height=*/0,
+                                                         coinbaseKey, script_pub_key, /*output_amount=*/49 * COIN,
+                                                         /*submit=*/false)};
+    CreateAndProcessBlock({tx}, script_pub_key);
+
+    // Let the BlockStatsIndex catch up again.
+    BOOST_CHECK(block_stats_index.BlockUntilSyncedToCurrentChain());
+
+    const CBlockIndex* new_block_index{WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip())};
+    CheckStatsFromDisk(*m_node.chainman, block_stats_index, *new_block_index);
+    const auto stats{block_stats_index.LookUpStats(*new_block_index)};
+    BOOST_REQUIRE(stats);
+    BOOST_CHECK_EQUAL(stats->txs, 2);
+    BOOST_CHECK_EQUAL(stats->ins, 1);
+    BOOST_CHECK_EQUAL(stats->totalfee, m_coinbase_txns[0]->vout[0].nValue - 49 * COIN);
+    BOOST_CHECK_EQUAL(stats->minfee, stats->totalfee);
+    BOOST_CHECK_EQUAL(stats->maxfee, stats->totalfee);
+    BOOST_CHECK_EQUAL(stats->medianfee, stats->totalfee);
+    BOOST_CHECK_EQUAL(stats->total_size, CTransaction{tx}.GetTotalSize());
+
+    // It is not safe to stop and destroy the index until it finishes handling
+    // the last BlockConnected notification, see coinstatsindex_tests.
+    SyncWithValidationInterfaceQueue();
+
+    // Shutdown sequence (c.f. Shutdown() in init.cpp)
+    block_stats_index.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
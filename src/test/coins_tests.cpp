@@ -1109,4 +1109,21 @@ BOOST_AUTO_TEST_CASE(coins_resource_is_used)
     PoolResourceTester::CheckAllDataAccountedFor(resource);
 }
 
+BOOST_AUTO_TEST_CASE(coins_db_key_order)
+{
+    uint256 low{InsecureRand256()};
+    *low.begin() &= 0xfe;
+    uint256 high{low};
+    *high.begin() |= 1;
+
+    // The hash is compared first, then the VARINT encoding of n
+    BOOST_CHECK(CoinsDBKeyLess(COutPoint{low, 1000}, COutPoint{high, 0}));
+    BOOST_CHECK(CoinsDBKeyLess(COutPoint{low, 0}, COutPoint{low, 1}));
+    BOOST_CHECK(CoinsDBKeyLess(COutPoint{low, 127}, COutPoint{low, 128}));
+    BOOST_CHECK(!CoinsDBKeyLess(COutPoint{low, 5}, COutPoint{low, 5}));
+    // 16512 encodes as 808000, before 16511 as FF7F
+    BOOST_CHECK(CoinsDBKeyLess(COutPoint{low, 16512}, COutPoint{low, 16511}));
+    BOOST_CHECK(!CoinsDBKeyLess(COutPoint{low, 16511}, COutPoint{low, 16512}));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -76,6 +76,36 @@ BOOST_FIXTURE_TEST_CASE(coinstatsindex_initial_sync, TestChain100Setup)
     coin_stats_index.Stop();
 }
 
+BOOST_FIXTURE_TEST_CASE(coinstatsindex_muhash_matches_utxo_set, TestChain100Setup)
+{
+    CoinStatsIndex coin_stats_index{interfaces::MakeChain(m_node), 1 << 20, true};
+    BOOST_REQUIRE(coin_stats_index.Init());
+    BOOST_REQUIRE(coin_stats_index.StartBackgroundSync());
+    IndexWaitSynced(coin_stats_index);
+
+    Chainstate& chainstate{m_node.chainman->ActiveChainstate()};
+    const CBlockIndex* tip;
+    CCoinsViewDB* coins_db;
+    {
+        LOCK(cs_main);
+        chainstate.ForceFlushStateToDisk();
+        tip = chainstate.m_chain.Tip();
+        coins_db = &chainstate.CoinsDB();
+    }
+    const auto index_stats{coin_stats_index.LookUpStats(*tip)};
+    BOOST_REQUIRE(index_stats);
+
+    // The UTXO set is hashed on worker threads, which must give the same
+    // result as the incrementally maintained index.
+    const auto utxo_stats{kernel::ComputeUTXOStats(kernel::CoinStatsHashType::MUHASH, coins_db, m_node.chainman->m_blockman)};
+    BOOST_REQUIRE(utxo_stats);
+    BOOST_CHECK_EQUAL(utxo_stats->hashSerialized, index_stats->hashSerialized);
+    BOOST_CHECK_EQUAL(utxo_stats->nTransactionOutputs, index_stats->nTransactionOutputs);
+
+    SyncWithValidationInterfaceQueue();
+    coin_stats_index.Stop();
+}
+
 // Test shutdown between BlockConnected and ChainStateFlushed notifications,
 // make sure index is not corrupted and is able to reload.
 BOOST_FIXTURE_TEST_CASE(coinstatsindex_unclean_shutdown, TestChain100Setup)
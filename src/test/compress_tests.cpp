@@ -2,8 +2,11 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <addresstype.h>
 #include <compressor.h>
+#include <primitives/block.h>
 #include <script/script.h>
+#include <streams.h>
 #include <test/util/setup_common.h>
 
 #include <stdint.h>
@@ -134,4 +137,46 @@ BOOST_AUTO_TEST_CASE(compress_script_to_uncompressed_pubkey_id)
     BOOST_CHECK_EQUAL(out[0], 0x04 | (script[65] & 0x01)); // least significant bit (lsb) of last char of pubkey is mapped into out[0]
 }
 
+BOOST_AUTO_TEST_CASE(compress_block_roundtrip)
+{
+    CKey key;
+    key.MakeNewKey(true);
+
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].prevout.SetNull();
+    coinbase.vin[0].scriptSig = CScript() << 1 << OP_0;
+    coinbase.vout.emplace_back(50 * COIN, GetScriptForDestination(PKHash(key.GetPubKey())));
+    coinbase.vout.emplace_back(0, CScript() << OP_RETURN << std::vector<unsigned char>(36, 0xaa));
+
+    CMutableTransaction spend;
+    spend.nVersion = -1;
+    spend.nLockTime = 500000;
+    spend.vin.resize(2);
+    spend.vin[0].prevout = COutPoint{coinbase.GetHash(), 0};
+    spend.vin[0].nSequence = CTxIn::SEQUENCE_FINAL - 2;
+    spend.vin[0].scriptWitness.stack = {std::vector<unsigned char>(72, 0x30), ToByteVector(key.GetPubKey())};
+    spend.vin[1].prevout = COutPoint{coinbase.GetHash(), 1};
+    spend.vin[1].nSequence = 0;
+    spend.vout.emplace_back(1234, GetScriptForDestination(WitnessV0KeyHash(key.GetPubKey())));
+
+    CBlock block;
+    block.nVersion = 4;
+    block.nTime = 1234567890;
+    block.vtx = {MakeTransactionRef(coinbase), MakeTransactionRef(spend)};
+
+    DataStream compressed{};
+    compressed << Using<BlockCompression>(block);
+    BOOST_CHECK_LT(compressed.size(), ::GetSerializeSize(block, PROTOCOL_VERSION));
+
+    CBlock decoded;
+    compressed >> Using<BlockCompression>(decoded);
+    BOOST_CHECK(compressed.empty());
+    BOOST_CHECK_EQUAL(decoded.GetHash(), block.GetHash());
+    BOOST_REQUIRE_EQUAL(decoded.vtx.size(), block.vtx.size());
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        BOOST_CHECK_EQUAL(decoded.vtx[i]->GetWitnessHash(), block.vtx[i]->GetWitnessHash());
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
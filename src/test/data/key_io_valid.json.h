@@ -0,0 +1,4 @@
+#include <string>
+namespace json_tests{
+static const std::string key_io_valid{
+};};
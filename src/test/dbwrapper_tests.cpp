@@ -2,7 +2,9 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <common/args.h>
 #include <dbwrapper.h>
+#include <node/database_args.h>
 #include <test/util/random.h>
 #include <test/util/setup_common.h>
 #include <uint256.h>
@@ -397,5 +399,49 @@ BOOST_AUTO_TEST_CASE(unicodepath)
     BOOST_CHECK(fs::exists(lockPath));
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_profiles)
+{
+    for (const auto profile : {node::DBProfile::DEFAULT, node::DBProfile::SSD, node::DBProfile::LOWMEM}) {
+        DBOptions options;
+        node::ApplyDBProfile(profile, options);
+        fs::path ph = m_args.GetDataDirBase() / fs::u8path(strprintf("dbwrapper_profile_%d", static_cast<int>(profile)));
+        CDBWrapper dbw({.path = ph, .cache_bytes = 1 << 20, .obfuscate = true, .options = options});
+
+        for (uint32_t i = 0; i < 1000; ++i) {
+            BOOST_CHECK(dbw.Write(i, uint256{static_cast<uint8_t>(i)}));
+        }
+        for (uint32_t i = 0; i < 1000; ++i) {
+            uint256 res;
+            BOOST_CHECK(dbw.Read(i, res));
+            BOOST_CHECK(res == uint256{static_cast<uint8_t>(i)});
+        }
+        BOOST_CHECK(!dbw.Exists(uint32_t{1000}));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(dbwrapper_profile_args)
+{
+    ArgsManager args;
+    args.AddArg("-dbprofile", "", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    const char* argv[] = {"ignored", "-dbprofile=lowmem", "-dbprofile=chainstate:ssd"};
+    std::string error;
+    BOOST_REQUIRE(args.ParseParameters(std::size(argv), argv, error));
+    BOOST_CHECK(node::CheckDatabaseArgs(args));
+
+    DBOptions chainstate, blocks;
+    node::ReadDatabaseArgs(args, chainstate, "chainstate");
+    node::ReadDatabaseArgs(args, blocks, "blocks");
+    BOOST_CHECK_EQUAL(chainstate.max_file_size, size_t{32 << 20});
+    BOOST_CHECK(!chainstate.compression);
+    BOOST_CHECK(blocks.compression);
+    BOOST_CHECK(blocks.write_buffer_size.has_value());
+
+    const char* bad_db[] = {"ignored", "-dbprofile=wallet:ssd"};
+    BOOST_REQUIRE(args.ParseParameters(std::size(bad_db), bad_db, error));
+    BOOST_CHECK(!node::CheckDatabaseArgs(args));
+    const char* bad_profile[] = {"ignored", "-dbprofile=fast"};
+    BOOST_REQUIRE(args.ParseParameters(std::size(bad_profile), bad_profile, error));
+    BOOST_CHECK(!node::CheckDatabaseArgs(args));
+}
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -54,6 +54,17 @@ FUZZ_TARGET(buffered_file)
                     } catch (const std::ios_base::failure&) {
                     }
                 },
+                [&] {
+                    if (setpos_fail) {
+                        return;
+                    }
+                    const std::vector<uint8_t> bytes{ConsumeRandomLengthByteVector(fuzzed_data_provider, 8)};
+                    if (bytes.empty()) return;
+                    try {
+                        opt_buffered_file->FindBytes(MakeByteSpan(bytes));
+                    } catch (const std::ios_base::failure&) {
+                    }
+                },
                 [&] {
                     ReadFromStream(fuzzed_data_provider, *opt_buffered_file);
                 });
@@ -0,0 +1,143 @@
+// Copyright (c) 2023 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <hash.h>
+#include <pubkey.h>
+#include <script/interpreter.h>
+#include <script/script.h>
+#include <test/fuzz/FuzzedDataProvider.h>
+#include <test/fuzz/fuzz.h>
+#include <test/fuzz/util.h>
+#include <test/util/script.h>
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+/** Non-static (and re-declared) from src/script/interpreter.cpp */
+bool CastToBool(const std::vector<unsigned char>& vch);
+
+namespace {
+//! Signature checker whose answer only depends on its arguments, so that
+//! both evaluations of a spend see the same results.
+class DeterministicSignatureChecker : public BaseSignatureChecker
+{
+public:
+    bool CheckECDSASignature(const std::vector<unsigned char>& sig, const std::vector<unsigned char>& pubkey, const CScript& script_code, SigVersion sigversion) const override
+    {
+        return !sig.empty() && !pubkey.empty() && ((sig.front() ^ pubkey.back() ^ script_code.size()) & 1);
+    }
+};
+
+/** VerifyScript for a scriptPubKey that is not P2SH, evaluated by EvalScript. */
+bool ReferenceVerifyScript(const CScript& script_sig, const CScript& script_pubkey, const CScriptWitness& witness, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror)
+{
+    if ((flags & SCRIPT_VERIFY_SIGPUSHONLY) && !script_sig.IsPushOnly()) {
+        *serror = SCRIPT_ERR_SIG_PUSHONLY;
+        return false;
+    }
+    std::vector<std::vector<unsigned char>> stack;
+    if (!EvalScript(stack, script_sig, flags, checker, SigVersion::BASE, serror)) return false;
+    if (!EvalScript(stack, script_pubkey, flags, checker, SigVersion::BASE, serror)) return false;
+    if (stack.empty() || !CastToBool(stack.back())) {
+        *serror = SCRIPT_ERR_EVAL_FALSE;
+        return false;
+    }
+    int witness_version;
+    std::vector<unsigned char> witness_program;
+    const bool had_witness{(flags & SCRIPT_VERIFY_WITNESS) && script_pubkey.IsWitnessProgram(witness_version, witness_program)};
+    if (had_witness) {
+        assert(witness_version == 0 && witness_program.size() == WITNESS_V0_KEYHASH_SIZE);
+        if (!script_sig.empty()) {
+            *serror = SCRIPT_ERR_WITNESS_MALLEATED;
+            return false;
+        }
+        if (witness.stack.size() != 2) {
+            *serror = SCRIPT_ERR_WITNESS_PROGRAM_MISMATCH;
+            return false;
+        }
+        // The witness script of P2WPKH, as run by ExecuteWitnessScript
+        stack = witness.stack;
+        for (const auto& elem : stack) {
+            if (elem.size() > MAX_SCRIPT_ELEMENT_SIZE) {
+                *serror = SCRIPT_ERR_PUSH_SIZE;
+                return false;
+            }
+        }
+        const CScript exec_script{CScript() << OP_DUP << OP_HASH160 << witness_program << OP_EQUALVERIFY << OP_CHECKSIG};
+        if (!EvalScript(stack, exec_script, flags, checker, SigVersion::WITNESS_V0, serror)) return false;
+        if (stack.size() != 1) {
+            *serror = SCRIPT_ERR_CLEANSTACK;
+            return false;
+        }
+        if (!CastToBool(stack.back())) {
+            *serror = SCRIPT_ERR_EVAL_FALSE;
+            return false;
+        }
+        stack.resize(1);
+    }
+    if ((flags & SCRIPT_VERIFY_CLEANSTACK) && stack.size() != 1) {
+        *serror = SCRIPT_ERR_CLEANSTACK;
+        return false;
+    }
+    if ((flags & SCRIPT_VERIFY_WITNESS) && !had_witness && !witness.IsNull()) {
+        *serror = SCRIPT_ERR_WITNESS_UNEXPECTED;
+        return false;
+    }
+    *serror = SCRIPT_ERR_OK;
+    return true;
+}
+} // namespace
+
+//! Check that the P2PKH and P2WPKH fast paths of VerifyScript agree with
+//! the interpreter, including on the reported error.
+FUZZ_TARGET(script_fast_path)
+{
+    FuzzedDataProvider fuzzed_data_provider(buffer.data(), buffer.size());
+    const unsigned int flags = fuzzed_data_provider.ConsumeIntegral<unsigned int>();
+    if (!IsValidFlagCombination(flags)) return;
+
+    const std::vector<unsigned char> sig{ConsumeRandomLengthByteVector(fuzzed_data_provider)};
+    const std::vector<unsigned char> pubkey{ConsumeRandomLengthByteVector(fuzzed_data_provider)};
+    std::vector<unsigned char> keyhash(WITNESS_V0_KEYHASH_SIZE);
+    if (fuzzed_data_provider.ConsumeBool()) {
+        const uint160 hash{Hash160(pubkey)};
+        keyhash.assign(hash.begin(), hash.end());
+    } else {
+        keyhash = fuzzed_data_provider.ConsumeBytes<unsigned char>(WITNESS_V0_KEYHASH_SIZE);
+        keyhash.resize(WITNESS_V0_KEYHASH_SIZE);
+    }
+
+    CScript script_sig;
+    CScript script_pubkey;
+    CScriptWitness witness;
+    if (fuzzed_data_provider.ConsumeBool()) {
+        script_pubkey << OP_DUP << OP_HASH160 << keyhash << OP_EQUALVERIFY << OP_CHECKSIG;
+        assert(script_pubkey.IsPayToPubKeyHash());
+        if (fuzzed_data_provider.ConsumeBool()) {
+            script_sig << sig << pubkey;
+        } else {
+            script_sig = ConsumeScript(fuzzed_data_provider);
+        }
+    } else {
+        // Without the witness flag the program is run as a plain script,
+        // which is not what is being compared here.
+        if (!(flags & SCRIPT_VERIFY_WITNESS)) return;
+        script_pubkey << OP_0 << keyhash;
+        if (fuzzed_data_provider.ConsumeBool()) script_sig = ConsumeScript(fuzzed_data_provider);
+        witness.stack.push_back(sig);
+        witness.stack.push_back(pubkey);
+    }
+    if (fuzzed_data_provider.ConsumeBool()) {
+        witness.stack.push_back(ConsumeRandomLengthByteVector(fuzzed_data_provider));
+    }
+
+    const DeterministicSignatureChecker checker;
+    ScriptError fast_error;
+    ScriptError reference_error;
+    const bool fast{VerifyScript(script_sig, script_pubkey, &witness, flags, checker, &fast_error)};
+    const bool reference{ReferenceVerifyScript(script_sig, script_pubkey, witness, flags, checker, &reference_error)};
+    assert(fast == reference);
+    assert(fast_error == reference_error);
+}
@@ -301,6 +301,20 @@ BOOST_AUTO_TEST_CASE(bip340_test_vectors)
         BOOST_CHECK_EQUAL(XOnlyPubKey(pubkey).VerifySchnorr(uint256(msg), sig), test.second);
     }
 
+    // A batch of the valid vectors verifies, adding any invalid one makes it fail.
+    BatchSchnorrVerifier batch;
+    BOOST_CHECK(batch.Verify());
+    for (const auto& test : VECTORS) {
+        if (test.second) batch.Add(XOnlyPubKey(ParseHex(test.first[0])), uint256(ParseHex(test.first[1])), ParseHex(test.first[2]));
+    }
+    BOOST_CHECK(batch.Verify());
+    for (const auto& test : VECTORS) {
+        if (test.second) continue;
+        BatchSchnorrVerifier bad_batch{batch};
+        bad_batch.Add(XOnlyPubKey(ParseHex(test.first[0])), uint256(ParseHex(test.first[1])), ParseHex(test.first[2]));
+        BOOST_CHECK(!bad_batch.Verify());
+    }
+
     static const std::vector<std::array<std::string, 5>> SIGN_VECTORS = {
         {{"0000000000000000000000000000000000000000000000000000000000000003", "F9308A019258C31049344F85F89D5229B531C845836F99B08601F113BCE036F9", "0000000000000000000000000000000000000000000000000000000000000000", "0000000000000000000000000000000000000000000000000000000000000000", "E907831F80848D1069A5371B402410364BDF1C5F8307B0084C55F1CE2DCA821525F66A4A85EA8B71E482A74F382D2CE5EBEEE8FDB2172F477DF4900D310536C0"}},
         {{"B7E151628AED2A6ABF7158809CF4F3C762E7160F38B4DA56A784D9045190CFEF", "DFF1D77F2A671C5F36183726DB2341BE58FEAE1DA2DECED843240F7B502BA659", "0000000000000000000000000000000000000000000000000000000000000001", "243F6A8885A308D313198A2E03707344A4093822299F31D0082EFA98EC4E6C89", "6896BD60EEAE296DB48A229FF71DFE071BDE413E6D43F917DC8DCF8C78DE33418906D11AC976ABCCB20B091292BFF4EA897EFCB639EA871CFA95F6DE339E4B0A"}},
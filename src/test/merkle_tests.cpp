@@ -349,4 +349,36 @@ BOOST_AUTO_TEST_CASE(merkle_test_BlockWitness)
 
     BOOST_CHECK_EQUAL(merkleRootofHashes, blockWitness);
 }
+
+BOOST_AUTO_TEST_CASE(merkle_test_BlockMerkleRoots)
+{
+    for (int i = 0; i < 40; i++) {
+        // Try all sizes from 0 to 32 inclusive, and then 7 random sizes.
+        int ntx = (i <= 32) ? i : 33 + InsecureRandRange(4000);
+        CBlock block;
+        block.vtx.resize(ntx);
+        for (int j = 0; j < ntx; j++) {
+            CMutableTransaction mtx;
+            mtx.nLockTime = j;
+            mtx.vin.resize(1);
+            mtx.vin[0].scriptWitness.stack.push_back(std::vector<unsigned char>(1, j & 0xff));
+            block.vtx[j] = MakeTransactionRef(std::move(mtx));
+        }
+        // Duplicate the last transaction for an odd number of transactions.
+        const bool mutate{ntx > 2 && (ntx & 1) == 1};
+        if (mutate) block.vtx.push_back(block.vtx.back());
+
+        bool mutated = false;
+        bool fused_mutated = false;
+        const auto [root, witness_root]{BlockMerkleRoots(block, &fused_mutated)};
+        BOOST_CHECK(root == BlockMerkleRoot(block, &mutated));
+        BOOST_CHECK_EQUAL(fused_mutated, mutated);
+        BOOST_CHECK_EQUAL(fused_mutated, mutate);
+        if (ntx == 0) {
+            BOOST_CHECK(witness_root.IsNull());
+        } else {
+            BOOST_CHECK(witness_root == BlockWitnessMerkleRoot(block));
+        }
+    }
+}
 BOOST_AUTO_TEST_SUITE_END()
@@ -1565,4 +1565,38 @@ BOOST_AUTO_TEST_CASE(v2transport_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(v1transport_external_payload)
+{
+    const auto payload{std::make_shared<const std::vector<unsigned char>>(g_insecure_rand_ctx.randbytes(1000))};
+
+    CSerializedNetMsg owned_msg;
+    owned_msg.m_type = NetMsgType::BLOCK;
+    owned_msg.data = *payload;
+
+    CSerializedNetMsg external_msg;
+    external_msg.m_type = NetMsgType::BLOCK;
+    external_msg.m_external_data = *payload;
+    external_msg.m_external_owner = payload;
+    BOOST_CHECK_GE(external_msg.GetMemoryUsage(), payload->size());
+
+    const auto wire_bytes{[](CSerializedNetMsg msg) {
+        V1Transport transport{0, SER_NETWORK, INIT_PROTO_VERSION};
+        BOOST_REQUIRE(transport.SetMessageToSend(msg));
+        std::vector<uint8_t> sent;
+        while (true) {
+            const auto& [bytes, _more, _msg_type] = transport.GetBytesToSend(/*have_next_message=*/false);
+            if (bytes.empty()) break;
+            sent.insert(sent.end(), bytes.begin(), bytes.end());
+            transport.MarkBytesSent(bytes.size());
+        }
+        // The transport drops its reference to the payload once it is sent
+        BOOST_CHECK_EQUAL(transport.GetSendMemoryUsage(), sizeof(CSerializedNetMsg));
+        return sent;
+    }};
+
+    // A payload held outside of the message goes on the wire exactly like an owned one
+    BOOST_CHECK(wire_bytes(owned_msg.Copy()) == wire_bytes(external_msg.Copy()));
+    BOOST_CHECK_EQUAL(payload.use_count(), 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
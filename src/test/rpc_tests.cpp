@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <core_io.h>
+#include <index/blockstatsindex.h>
 #include <interfaces/chain.h>
 #include <node/context.h>
 #include <rpc/blockchain.h>
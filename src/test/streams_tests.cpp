@@ -550,6 +550,32 @@ BOOST_AUTO_TEST_CASE(streams_buffered_file_rand)
     fs::remove(streams_test_filename);
 }
 
+BOOST_AUTO_TEST_CASE(streams_buffered_file_find_bytes)
+{
+    fs::path streams_test_filename = m_args.GetDataDirBase() / "streams_test_tmp";
+    CAutoFile file{fsbridge::fopen(streams_test_filename, "w+b"), 333};
+    // Partial matches, one of them across the end of the buffer, before the sequence at 30
+    const std::vector<uint8_t> data{0, 1, 7, 8, 7, 8, 9, 0, 7, 0, 0, 0, 0, 0, 0, 0, 0, 0, 7, 8,
+                                    9, 0, 0, 0, 0, 0, 0, 0, 0, 0, 7, 8, 9, 10, 0, 0, 0, 7, 8};
+    file << Span{data};
+    std::rewind(file.Get());
+    const std::vector<std::byte> find{std::byte{7}, std::byte{8}, std::byte{9}, std::byte{10}};
+
+    BufferedFile bf{file, /*nBufSize=*/20, /*nRewindIn=*/4};
+    bf.FindBytes(find);
+    BOOST_CHECK_EQUAL(bf.GetPos(), 30U);
+    uint8_t i;
+    bf >> i;
+    BOOST_CHECK_EQUAL(i, 7);
+
+    // Only a partial match before the end of the file
+    BOOST_CHECK_THROW(bf.FindBytes(find), std::ios_base::failure);
+    BOOST_CHECK_EQUAL(bf.GetPos(), data.size() - 2);
+
+    file.fclose();
+    fs::remove(streams_test_filename);
+}
+
 BOOST_AUTO_TEST_CASE(streams_hashed)
 {
     DataStream stream{};
@@ -31,6 +31,7 @@
 
 #include <functional>
 #include <map>
+#include <optional>
 #include <string>
 
 #include <boost/test/unit_test.hpp>
@@ -556,6 +557,56 @@ BOOST_AUTO_TEST_CASE(test_big_witness_transaction)
     scriptcheckqueue.StopWorkerThreads();
 }
 
+BOOST_AUTO_TEST_CASE(run_checks_batch_schnorr)
+{
+    // A transaction with taproot key path spends of keys that are all different
+    static constexpr int NUM_INPUTS{10};
+    const uint32_t flags{SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_WITNESS | SCRIPT_VERIFY_TAPROOT};
+    std::vector<CKey> keys(NUM_INPUTS);
+    std::vector<CTxOut> spent_outputs;
+    CMutableTransaction mtx;
+    for (int i = 0; i < NUM_INPUTS; ++i) {
+        keys[i].MakeNewKey(true);
+        const XOnlyPubKey output_key{XOnlyPubKey{keys[i].GetPubKey()}.CreateTapTweak(nullptr)->first};
+        spent_outputs.emplace_back(1000, CScript() << OP_1 << ToByteVector(output_key));
+        mtx.vin.emplace_back(COutPoint{InsecureRand256(), 0});
+    }
+    mtx.vout.emplace_back(1000, CScript() << OP_TRUE);
+    PrecomputedTransactionData txdata;
+    txdata.Init(mtx, std::vector<CTxOut>{spent_outputs}, /*force=*/true);
+    for (int i = 0; i < NUM_INPUTS; ++i) {
+        ScriptExecutionData execdata;
+        execdata.m_annex_init = true;
+        execdata.m_annex_present = false;
+        uint256 sighash;
+        BOOST_REQUIRE(SignatureHashSchnorr(sighash, execdata, mtx, i, SIGHASH_DEFAULT, SigVersion::TAPROOT, txdata, MissingDataBehavior::FAIL));
+        std::vector<unsigned char> sig(64);
+        BOOST_REQUIRE(keys[i].SignSchnorr(sighash, sig, nullptr, InsecureRand256()));
+        mtx.vin[i].scriptWitness.stack.push_back(std::move(sig));
+    }
+
+    const auto run_checks{[&](const CTransaction& tx, std::optional<int> expected_failure) {
+        PrecomputedTransactionData tx_txdata;
+        tx_txdata.Init(tx, std::vector<CTxOut>{spent_outputs});
+        std::vector<CScriptCheck> checks;
+        for (int i = 0; i < NUM_INPUTS; ++i) {
+            checks.emplace_back(spent_outputs[i], tx, i, flags, /*cacheIn=*/false, &tx_txdata);
+        }
+        BOOST_CHECK_EQUAL(RunChecks(checks), !expected_failure);
+        for (int i = 0; i < NUM_INPUTS; ++i) {
+            BOOST_CHECK_EQUAL(checks[i].GetScriptError(), i == expected_failure ? SCRIPT_ERR_SCHNORR_SIG : SCRIPT_ERR_OK);
+        }
+    }};
+
+    run_checks(CTransaction{mtx}, std::nullopt);
+
+    // Invalidate the signature of one input: the batch fails, and running the
+    // checks one by one finds the failing input.
+    const int bad_input{int(InsecureRandRange(NUM_INPUTS))};
+    mtx.vin[bad_input].scriptWitness.stack[0][InsecureRandRange(64)] ^= 1 << InsecureRandRange(8);
+    run_checks(CTransaction{mtx}, bad_input);
+}
+
 SignatureData CombineSignatures(const CMutableTransaction& input1, const CMutableTransaction& input2, const CTransactionRef tx)
 {
     SignatureData sigdata;
@@ -77,4 +77,42 @@ BOOST_FIXTURE_TEST_CASE(txindex_initial_sync, TestChain100Setup)
     txindex.Stop();
 }
 
+struct CompressedBlocksSetup : public TestChain100Setup {
+    CompressedBlocksSetup() : TestChain100Setup{ChainType::REGTEST, {"-blockcompression"}} {}
+};
+
+BOOST_FIXTURE_TEST_CASE(txindex_block_compression, CompressedBlocksSetup)
+{
+    // A block whose transaction is not the first one in the record
+    const CScript coinbase_script_pub_key{GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()))};
+    const CMutableTransaction spend{CreateValidMempoolTransaction(m_coinbase_txns[0], /*input_vout=*/0, /*input_height=*/1, coinbaseKey, coinbase_script_pub_key, /*output_amount=*/1 * COIN, /*submit=*/false)};
+    const CBlock spend_block{CreateAndProcessBlock({spend}, coinbase_script_pub_key)};
+    BOOST_REQUIRE_EQUAL(spend_block.vtx.size(), 2U);
+
+    const CBlockIndex* tip{WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip())};
+    BOOST_REQUIRE(m_node.chainman->m_blockman.IsCompressedBlockRecord(WITH_LOCK(cs_main, return tip->GetBlockPos())));
+
+    TxIndex txindex(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(txindex.Init());
+    BOOST_REQUIRE(txindex.StartBackgroundSync());
+    IndexWaitSynced(txindex);
+
+    // Transactions are found by decoding the compressed records
+    CTransactionRef tx_disk;
+    uint256 block_hash;
+    for (size_t i = 0; i < m_coinbase_txns.size(); ++i) {
+        BOOST_REQUIRE(txindex.FindTx(m_coinbase_txns[i]->GetHash(), block_hash, tx_disk));
+        BOOST_CHECK_EQUAL(tx_disk->GetHash(), m_coinbase_txns[i]->GetHash());
+        BOOST_CHECK_EQUAL(block_hash, WITH_LOCK(cs_main, return m_node.chainman->ActiveChain()[i + 1]->GetBlockHash()));
+    }
+    for (const auto& txn : spend_block.vtx) {
+        BOOST_REQUIRE(txindex.FindTx(txn->GetHash(), block_hash, tx_disk));
+        BOOST_CHECK_EQUAL(tx_disk->GetHash(), txn->GetHash());
+        BOOST_CHECK_EQUAL(block_hash, spend_block.GetHash());
+    }
+
+    SyncWithValidationInterfaceQueue();
+    txindex.Stop();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2,18 +2,26 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <clientversion.h>
 #include <consensus/validation.h>
 #include <key.h>
+#include <kernel/validation_cache_persist.h>
+#include <kernel/validation_cache_sizes.h>
 #include <random.h>
+#include <script/sigcache.h>
 #include <script/sign.h>
 #include <script/signingprovider.h>
+#include <streams.h>
 #include <test/util/setup_common.h>
 #include <txmempool.h>
 #include <util/chaintype.h>
+#include <util/fs.h>
 #include <validation.h>
 
 #include <boost/test/unit_test.hpp>
 
+#include <cstdio>
+
 struct Dersig100Setup : public TestChain100Setup {
     Dersig100Setup()
         : TestChain100Setup{ChainType::REGTEST, {"-testactivationheight=dersig@102"}} {}
@@ -22,7 +30,8 @@ struct Dersig100Setup : public TestChain100Setup {
 bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
                        const CCoinsViewCache& inputs, unsigned int flags, bool cacheSigStore,
                        bool cacheFullScriptStore, PrecomputedTransactionData& txdata,
-                       std::vector<CScriptCheck>* pvChecks) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+                       std::vector<CScriptCheck>* pvChecks,
+                       std::once_flag* txdata_once = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
 BOOST_AUTO_TEST_SUITE(txvalidationcache_tests)
 
@@ -332,6 +341,23 @@ BOOST_FIXTURE_TEST_CASE(checkinputs_test, Dersig100Setup)
         BOOST_CHECK(ProduceSignature(keystore, MutableTransactionSignatureCreator(valid_with_witness_tx, 0, 11 * CENT, SIGHASH_ALL), spend_tx.vout[1].scriptPubKey, sigdata));
         UpdateInput(valid_with_witness_tx.vin[0], sigdata);
 
+        {
+            // Given a once flag, the queued script checks compute the
+            // transaction hashes when the first of them runs.
+            TxValidationState state;
+            PrecomputedTransactionData txdata;
+            std::once_flag txdata_once;
+            std::vector<CScriptCheck> scriptchecks;
+            const CTransaction tx{valid_with_witness_tx};
+            BOOST_CHECK(CheckInputScripts(tx, state, &m_node.chainman->ActiveChainstate().CoinsTip(), SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_WITNESS, true, false, txdata, &scriptchecks, &txdata_once));
+            BOOST_CHECK_EQUAL(scriptchecks.size(), 1U);
+            BOOST_CHECK(txdata.m_spent_outputs_ready);
+            BOOST_CHECK(!txdata.m_bip143_segwit_ready);
+            BOOST_CHECK(scriptchecks[0]());
+            BOOST_CHECK(txdata.m_bip143_segwit_ready);
+            BOOST_CHECK(txdata.hashPrevouts == PrecomputedTransactionData{tx}.hashPrevouts);
+        }
+
         // This should be valid under all script flags.
         ValidateCheckInputsForAllFlags(CTransaction(valid_with_witness_tx), 0, true, m_node.chainman->ActiveChainstate().CoinsTip());
 
@@ -383,4 +409,76 @@ BOOST_FIXTURE_TEST_CASE(checkinputs_test, Dersig100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(validation_cache_persist, Dersig100Setup)
+{
+    // Test that the caches keep their entries, and the salts they were
+    // computed with, across a dump and reload.
+    CMutableTransaction spend_tx;
+    spend_tx.nVersion = 1;
+    spend_tx.vin.resize(1);
+    spend_tx.vin[0].prevout = COutPoint{m_coinbase_txns[0]->GetHash(), 0};
+    spend_tx.vout.resize(1);
+    spend_tx.vout[0].nValue = 11 * CENT;
+    spend_tx.vout[0].scriptPubKey = GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()));
+    {
+        std::vector<unsigned char> vchSig;
+        uint256 hash = SignatureHash(m_coinbase_txns[0]->vout[0].scriptPubKey, spend_tx, 0, SIGHASH_ALL, 0, SigVersion::BASE);
+        BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+        vchSig.push_back((unsigned char)SIGHASH_ALL);
+        spend_tx.vin[0].scriptSig << vchSig;
+    }
+    const CTransaction tx{spend_tx};
+    const unsigned int flags{SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_DERSIG};
+    const fs::path path{m_args.GetDataDirNet() / "validationcache.dat"};
+
+    // Returns the number of script checks left after consulting the cache.
+    const auto CountScriptChecks = [&]() EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+        TxValidationState state;
+        PrecomputedTransactionData txdata;
+        std::vector<CScriptCheck> scriptchecks;
+        BOOST_CHECK(CheckInputScripts(tx, state, m_node.chainman->ActiveChainstate().CoinsTip(), flags, true, true, txdata, &scriptchecks));
+        return scriptchecks.size();
+    };
+
+    {
+        LOCK(cs_main);
+        TxValidationState state;
+        PrecomputedTransactionData txdata;
+        BOOST_CHECK(CheckInputScripts(tx, state, m_node.chainman->ActiveChainstate().CoinsTip(), flags, true, true, txdata, nullptr));
+        BOOST_CHECK_EQUAL(CountScriptChecks(), 0U);
+    }
+    std::vector<uint256> sig_entries;
+    const uint256 sig_nonce{GetSignatureCacheEntries(sig_entries)};
+    BOOST_CHECK(!sig_entries.empty());
+    BOOST_REQUIRE(kernel::DumpValidationCaches(path, fsbridge::fopen, /*skip_file_commit=*/true));
+
+    // Reinitializing picks a fresh salt, so the transaction is checked again.
+    const kernel::ValidationCacheSizes sizes{};
+    BOOST_REQUIRE(InitScriptExecutionCache(sizes.script_execution_cache_bytes));
+    BOOST_CHECK_EQUAL(WITH_LOCK(cs_main, return CountScriptChecks()), 1U);
+
+    BOOST_REQUIRE(kernel::LoadValidationCaches(path));
+    BOOST_CHECK_EQUAL(WITH_LOCK(cs_main, return CountScriptChecks()), 0U);
+    std::vector<uint256> loaded_sig_entries;
+    BOOST_CHECK(GetSignatureCacheEntries(loaded_sig_entries) == sig_nonce);
+    for (const uint256& entry : sig_entries) {
+        BOOST_CHECK(std::find(loaded_sig_entries.begin(), loaded_sig_entries.end(), entry) != loaded_sig_entries.end());
+    }
+
+    // A file written by another client version only restores the signatures.
+    {
+        AutoFile file{fsbridge::fopen(path, "rb+")};
+        BOOST_REQUIRE(!file.IsNull());
+        BOOST_REQUIRE_EQUAL(std::fseek(file.Get(), sizeof(uint64_t), SEEK_SET), 0);
+        file << int{CLIENT_VERSION - 1};
+    }
+    BOOST_REQUIRE(InitScriptExecutionCache(sizes.script_execution_cache_bytes));
+    BOOST_REQUIRE(kernel::LoadValidationCaches(path));
+    BOOST_CHECK_EQUAL(WITH_LOCK(cs_main, return CountScriptChecks()), 1U);
+    BOOST_CHECK(GetSignatureCacheEntries(loaded_sig_entries) == sig_nonce);
+
+    // A missing file is reported but harmless.
+    BOOST_CHECK(!kernel::LoadValidationCaches(m_args.GetDataDirNet() / "missing.dat"));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -22,6 +22,7 @@
 #include <logging.h>
 #include <net.h>
 #include <net_processing.h>
+#include <node/blockmanager_args.h>
 #include <node/blockstorage.h>
 #include <node/chainstate.h>
 #include <node/context.h>
@@ -177,11 +178,12 @@ ChainTestingSetup::ChainTestingSetup(const ChainType chainType, const std::vecto
         .check_block_index = true,
         .notifications = *m_node.notifications,
     };
-    const BlockManager::Options blockman_opts{
+    BlockManager::Options blockman_opts{
         .chainparams = chainman_opts.chainparams,
         .blocks_dir = m_args.GetBlocksDirPath(),
         .notifications = chainman_opts.notifications,
     };
+    Assert(ApplyArgsManOptions(*m_node.args, blockman_opts));
     m_node.chainman = std::make_unique<ChainstateManager>(m_node.kernel->interrupt, chainman_opts, blockman_opts);
     m_node.chainman->m_blockman.m_block_tree_db = std::make_unique<BlockTreeDB>(DBParams{
         .path = m_args.GetDataDirNet() / "blocks" / "index",
@@ -4,6 +4,7 @@
 //
 #include <chainparams.h>
 #include <consensus/validation.h>
+#include <kernel/coinscache_persist.h>
 #include <random.h>
 #include <rpc/blockchain.h>
 #include <sync.h>
@@ -140,4 +141,62 @@ BOOST_FIXTURE_TEST_CASE(chainstate_update_tip, TestChain100Setup)
     BOOST_CHECK_EQUAL(curr_tip, ::g_best_block);
 }
 
+//! Test that the coins cache contents survive a dump, flush and reload.
+BOOST_FIXTURE_TEST_CASE(chainstate_coinscache_persist, TestChain100Setup)
+{
+    Chainstate& chainstate{Assert(m_node.chainman)->ActiveChainstate()};
+    const fs::path path{m_args.GetDataDirNet() / "coinscache.dat"};
+
+    std::vector<COutPoint> outpoints;
+    for (const auto& tx : m_coinbase_txns) outpoints.emplace_back(tx->GetHash(), 0);
+
+    {
+        LOCK(::cs_main);
+        for (const auto& outpoint : outpoints) {
+            BOOST_CHECK(!chainstate.CoinsTip().AccessCoin(outpoint).IsSpent());
+        }
+    }
+    BOOST_REQUIRE(kernel::DumpCoinsCache(chainstate, path, fsbridge::fopen, /*skip_file_commit=*/true));
+
+    {
+        LOCK(::cs_main);
+        chainstate.ForceFlushStateToDisk();
+        for (const auto& outpoint : outpoints) {
+            BOOST_CHECK(!chainstate.CoinsTip().HaveCoinInCache(outpoint));
+        }
+    }
+
+    BOOST_REQUIRE(kernel::LoadCoinsCache(chainstate, path));
+    {
+        LOCK(::cs_main);
+        for (const auto& outpoint : outpoints) {
+            BOOST_CHECK(chainstate.CoinsTip().HaveCoinInCache(outpoint));
+        }
+    }
+
+    // A missing file is reported but harmless.
+    BOOST_CHECK(!kernel::LoadCoinsCache(chainstate, m_args.GetDataDirNet() / "missing.dat"));
+}
+
+//! Test that shutting down after the chainstate failed to load keeps the
+//! coins cache file.
+BOOST_FIXTURE_TEST_CASE(chainstate_coinscache_persist_not_loaded, TestChain100Setup)
+{
+    ChainstateManager& chainman{*Assert(m_node.chainman)};
+    const fs::path path{m_args.GetDataDirNet() / "coinscache.dat"};
+    BOOST_REQUIRE(kernel::DumpCoinsCache(chainman.ActiveChainstate(), path, fsbridge::fopen, /*skip_file_commit=*/true));
+    const auto file_size{fs::file_size(path)};
+    BOOST_CHECK_GT(file_size, 0U);
+
+    // The initload thread, which loads the file, was never started, so
+    // Shutdown() does not dump the coins cache.
+    BOOST_CHECK(!chainman.m_coins_cache_load_tried);
+
+    // A chainstate whose coins views were never initialized is not dumped.
+    Chainstate not_loaded{/*mempool=*/nullptr, chainman.m_blockman, chainman};
+    BOOST_CHECK(!WITH_LOCK(::cs_main, return not_loaded.CanFlushToDisk()));
+    BOOST_CHECK(!kernel::DumpCoinsCache(not_loaded, path, fsbridge::fopen, /*skip_file_commit=*/true));
+    BOOST_CHECK_EQUAL(fs::file_size(path), file_size);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2,9 +2,11 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 //
+#include <arith_uint256.h>
 #include <chainparams.h>
 #include <consensus/validation.h>
 #include <kernel/disconnected_transactions.h>
+#include <node/chainstatemanager_args.h>
 #include <node/kernel_notifications.h>
 #include <node/utxo_snapshot.h>
 #include <random.h>
@@ -17,6 +19,7 @@
 #include <test/util/validation.h>
 #include <timedata.h>
 #include <uint256.h>
+#include <util/string.h>
 #include <validation.h>
 #include <validationinterface.h>
 
@@ -406,6 +409,55 @@ BOOST_FIXTURE_TEST_CASE(chainstatemanager_activate_snapshot, SnapshotTestSetup)
     this->SetupSnapshot();
 }
 
+//! Test activation of a snapshot in the chunked (version 2) format.
+BOOST_FIXTURE_TEST_CASE(chainstatemanager_activate_chunked_snapshot, TestChain100Setup)
+{
+    ChainstateManager& chainman = *Assert(m_node.chainman);
+    mineBlocks(10);
+
+    BOOST_REQUIRE(!CreateAndActivateUTXOSnapshot(
+        this, [](AutoFile& auto_infile, SnapshotMetadata& metadata) {
+            // Misaligned chunk
+            uint8_t byte;
+            auto_infile >> byte;
+        },
+        /*reset_chainstate=*/false, /*in_memory_chainstate=*/true, node::SNAPSHOT_VERSION_CHUNKED));
+    BOOST_CHECK(!chainman.IsSnapshotActive());
+
+    BOOST_REQUIRE(CreateAndActivateUTXOSnapshot(
+        this, NoMalleation, /*reset_chainstate=*/false, /*in_memory_chainstate=*/true, node::SNAPSHOT_VERSION_CHUNKED));
+    BOOST_CHECK(chainman.IsSnapshotActive());
+    LOCK(::cs_main);
+    for (const CTransactionRef& txn : m_coinbase_txns) {
+        BOOST_CHECK(chainman.ActiveChainstate().CoinsTip().HaveCoin(COutPoint{txn->GetHash(), 0}));
+    }
+}
+
+//! Test that version 1 snapshot metadata cannot be mistaken for a newer version.
+BOOST_FIXTURE_TEST_CASE(snapshot_metadata_versions, BasicTestingSetup)
+{
+    uint256 magic;
+    std::copy(node::SNAPSHOT_MAGIC_BYTES.begin(), node::SNAPSHOT_MAGIC_BYTES.end(), magic.begin());
+    for (const ChainType chain_type : {ChainType::MAIN, ChainType::TESTNET, ChainType::SIGNET, ChainType::REGTEST}) {
+        const auto params{CreateChainParams(ArgsManager{}, chain_type)};
+        BOOST_CHECK(UintToArith256(params->GetConsensus().powLimit) < UintToArith256(magic));
+    }
+
+    // A version 1 base block hash that starts like the magic bytes
+    uint256 hash{magic};
+    *(hash.end() - 1) = 0x7f;
+    for (const uint16_t version : {node::SNAPSHOT_VERSION_FLAT, node::SNAPSHOT_VERSION_CHUNKED}) {
+        DataStream stream{};
+        stream << SnapshotMetadata{hash, 42, version};
+        SnapshotMetadata metadata;
+        stream >> metadata;
+        BOOST_CHECK(stream.empty());
+        BOOST_CHECK_EQUAL(metadata.m_version, version);
+        BOOST_CHECK(metadata.m_base_blockhash == hash);
+        BOOST_CHECK_EQUAL(metadata.m_coins_count, 42U);
+    }
+}
+
 //! Test LoadBlockIndex behavior when multiple chainstates are in use.
 //!
 //! - First, verify that setBlockIndexCandidates is as expected when using a single,
@@ -775,4 +827,26 @@ BOOST_FIXTURE_TEST_CASE(chainstatemanager_snapshot_completion_hash_mismatch, Sna
     }
 }
 
+//! Test that -loadblockbuffer is limited to sizes BufferedFile can handle.
+BOOST_AUTO_TEST_CASE(chainstatemanager_args_loadblockbuffer)
+{
+    const auto buffer_bytes{[&](std::optional<int64_t> value) {
+        ArgsManager args;
+        if (value) args.ForceSetArg("-loadblockbuffer", ToString(*value));
+        ChainstateManager::Options opts{
+            .chainparams = Params(),
+            .datadir = m_args.GetDataDirNet(),
+            .notifications = *m_node.notifications,
+        };
+        BOOST_REQUIRE(node::ApplyArgsManOptions(args, opts));
+        return opts.loadblock_buffer_bytes;
+    }};
+    BOOST_CHECK_EQUAL(buffer_bytes(std::nullopt), size_t{DEFAULT_LOADBLOCK_BUFFER_MB << 20});
+    BOOST_CHECK_EQUAL(buffer_bytes(0), size_t{2 * MAX_BLOCK_SERIALIZED_SIZE});
+    BOOST_CHECK_EQUAL(buffer_bytes(MAX_LOADBLOCK_BUFFER_MB), size_t{MAX_LOADBLOCK_BUFFER_MB << 20});
+    BOOST_CHECK_EQUAL(buffer_bytes(MAX_LOADBLOCK_BUFFER_MB + 1), size_t{MAX_LOADBLOCK_BUFFER_MB << 20});
+    BOOST_CHECK_EQUAL(buffer_bytes(std::numeric_limits<int64_t>::max()), size_t{MAX_LOADBLOCK_BUFFER_MB << 20});
+    BOOST_CHECK_LT(uint64_t{MAX_LOADBLOCK_BUFFER_MB << 20}, uint64_t{1} << 32);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,12 +4,15 @@
 
 #include <chainparams.h>
 #include <consensus/amount.h>
+#include <consensus/validation.h>
 #include <net.h>
 #include <signet.h>
+#include <streams.h>
 #include <uint256.h>
 #include <util/chaintype.h>
 #include <validation.h>
 
+#include <test/util/random.h>
 #include <test/util/setup_common.h>
 
 #include <boost/test/unit_test.hpp>
@@ -122,6 +125,54 @@ BOOST_AUTO_TEST_CASE(signet_parse_tests)
     BOOST_CHECK(!CheckSignetBlockSolution(block, signet_params->GetConsensus()));
 }
 
+BOOST_AUTO_TEST_CASE(parallel_block_checks)
+{
+    // Enough transactions to deserialize and check the block on several threads
+    CBlock block;
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].scriptSig = CScript() << OP_1 << OP_1;
+    coinbase.vout.emplace_back(50 * COIN, CScript() << OP_TRUE);
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+    for (size_t i = 1; i < 2 * MIN_PARALLEL_BLOCK_TXS; ++i) {
+        CMutableTransaction mtx;
+        mtx.vin.emplace_back(COutPoint{InsecureRand256(), 0});
+        mtx.vin[0].scriptWitness.stack.emplace_back(1, i & 0xff);
+        mtx.vout.emplace_back(COIN, CScript() << OP_TRUE);
+        block.vtx.push_back(MakeTransactionRef(mtx));
+    }
+
+    CDataStream stream{SER_NETWORK, PROTOCOL_VERSION};
+    stream << block;
+    CBlock serial;
+    CBlock parallel;
+    CDataStream{stream} >> serial;
+    CDataStream parallel_stream{stream};
+    UnserializeBlock(parallel_stream, parallel);
+    BOOST_CHECK(parallel_stream.empty());
+    BOOST_CHECK_EQUAL(parallel.GetHash(), block.GetHash());
+    BOOST_REQUIRE_EQUAL(parallel.vtx.size(), block.vtx.size());
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        BOOST_CHECK_EQUAL(parallel.vtx[i]->GetWitnessHash(), block.vtx[i]->GetWitnessHash());
+        BOOST_CHECK_EQUAL(serial.vtx[i]->GetWitnessHash(), block.vtx[i]->GetWitnessHash());
+    }
+
+    const auto& consensus{Params().GetConsensus()};
+    BlockValidationState state;
+    BOOST_CHECK(CheckBlock(parallel, state, consensus, /*fCheckPOW=*/false, /*fCheckMerkleRoot=*/false));
+
+    // The first invalid transaction is reported, wherever it is checked
+    for (size_t i : {MIN_PARALLEL_BLOCK_TXS + 1, MIN_PARALLEL_BLOCK_TXS - 1}) {
+        CMutableTransaction mtx{*parallel.vtx[i]};
+        mtx.vin.push_back(mtx.vin[0]);
+        parallel.vtx[i] = MakeTransactionRef(mtx);
+    }
+    state = BlockValidationState{};
+    BOOST_CHECK(!CheckBlock(parallel, state, consensus, /*fCheckPOW=*/false, /*fCheckMerkleRoot=*/false));
+    BOOST_CHECK_EQUAL(state.GetRejectReason(), "bad-txns-inputs-duplicate");
+    BOOST_CHECK(state.GetDebugMessage().find(parallel.vtx[MIN_PARALLEL_BLOCK_TXS - 1]->GetHash().ToString()) != std::string::npos);
+}
+
 //! Test retrieval of valid assumeutxo values.
 BOOST_AUTO_TEST_CASE(test_assumeutxo)
 {
@@ -11,9 +11,12 @@
 #include <primitives/transaction.h>
 #include <random.h>
 #include <serialize.h>
+#include <span.h>
 #include <uint256.h>
 #include <util/vector.h>
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdlib>
 #include <iterator>
@@ -44,8 +47,37 @@ struct CoinEntry {
     SERIALIZE_METHODS(CoinEntry, obj) { READWRITE(obj.key, obj.outpoint->hash, VARINT(obj.outpoint->n)); }
 };
 
+//! The VARINT(n) at the end of a CoinEntry key, encoded without allocating.
+class VarIntKey
+{
+    std::array<std::byte, 5> m_bytes{};
+    size_t m_size{0};
+
+public:
+    explicit VarIntKey(uint32_t n) { ::Serialize(*this, VARINT(n)); }
+
+    void write(Span<const std::byte> src)
+    {
+        assert(m_size + src.size() <= m_bytes.size());
+        std::copy(src.begin(), src.end(), m_bytes.begin() + m_size);
+        m_size += src.size();
+    }
+
+    bool operator<(const VarIntKey& other) const
+    {
+        return std::lexicographical_compare(m_bytes.begin(), m_bytes.begin() + m_size,
+                                            other.m_bytes.begin(), other.m_bytes.begin() + other.m_size);
+    }
+};
+
 } // namespace
 
+bool CoinsDBKeyLess(const COutPoint& a, const COutPoint& b)
+{
+    if (a.hash != b.hash) return a.hash < b.hash;
+    return VarIntKey{a.n} < VarIntKey{b.n};
+}
+
 CCoinsViewDB::CCoinsViewDB(DBParams db_params, CoinsViewOptions options) :
     m_db_params{std::move(db_params)},
     m_options{std::move(options)},
@@ -77,4 +77,11 @@ public:
     std::optional<fs::path> StoragePath() { return m_db->StoragePath(); }
 };
 
+/**
+ * Whether a comes before b in the coins database, which is keyed by the
+ * outpoint hash followed by VARINT(n). VARINT does not preserve the order of
+ * n (16511 encodes as FF7F, 16512 as 808000), so this compares the encoded bytes.
+ */
+bool CoinsDBKeyLess(const COutPoint& a, const COutPoint& b);
+
 #endif // OCVCOIN_TXDB_H
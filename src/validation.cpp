@@ -13,6 +13,7 @@
 #include <chain.h>
 #include <checkqueue.h>
 #include <clientversion.h>
+#include <compressor.h>
 #include <consensus/amount.h>
 #include <consensus/consensus.h>
 #include <consensus/merkle.h>
@@ -29,6 +30,7 @@
 #include <kernel/notifications_interface.h>
 #include <logging.h>
 #include <logging/timer.h>
+#include <node/block_prefetcher.h>
 #include <node/blockstorage.h>
 #include <node/utxo_snapshot.h>
 #include <policy/policy.h>
@@ -37,6 +39,7 @@
 #include <pow.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
+#include <pubkey.h>
 #include <random.h>
 #include <reverse_iterator.h>
 #include <script/script.h>
@@ -55,6 +58,8 @@
 #include <util/rbf.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
+#include <util/thread.h>
+#include <util/threadnames.h>
 #include <util/time.h>
 #include <util/trace.h>
 #include <util/translation.h>
@@ -64,10 +69,15 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
 #include <deque>
+#include <exception>
+#include <functional>
 #include <numeric>
 #include <optional>
 #include <string>
+#include <system_error>
+#include <thread>
 #include <tuple>
 #include <utility>
 
@@ -82,6 +92,9 @@ using node::BlockMap;
 using node::CBlockIndexHeightOnlyComparator;
 using node::CBlockIndexWorkComparator;
 using node::fReindex;
+using node::ReadSnapshotChunk;
+using node::SNAPSHOT_VERSION_CHUNKED;
+using node::SnapshotChunkInfo;
 using node::SnapshotMetadata;
 
 /** Time to wait between writing blocks/block index to disk. */
@@ -132,7 +145,8 @@ const CBlockIndex* Chainstate::FindForkInGlobalIndex(const CBlockLocator& locato
 bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
                        const CCoinsViewCache& inputs, unsigned int flags, bool cacheSigStore,
                        bool cacheFullScriptStore, PrecomputedTransactionData& txdata,
-                       std::vector<CScriptCheck>* pvChecks = nullptr)
+                       std::vector<CScriptCheck>* pvChecks = nullptr,
+                       std::once_flag* txdata_once = nullptr)
                        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
 bool CheckFinalTxAtTip(const CBlockIndex& active_chain_tip, const CTransaction& tx)
@@ -1805,24 +1819,50 @@ void UpdateCoins(const CTransaction& tx, CCoinsViewCache& inputs, CTxUndo &txund
     AddCoins(inputs, tx, nHeight);
 }
 
-bool CScriptCheck::operator()() {
+bool CScriptCheck::operator()(BatchSchnorrVerifier* batch) {
+    if (m_txdata_once) std::call_once(*m_txdata_once, [this] { txdata->ComputeHashes(*ptxTo); });
     const CScript &scriptSig = ptxTo->vin[nIn].scriptSig;
     const CScriptWitness *witness = &ptxTo->vin[nIn].scriptWitness;
-    return VerifyScript(scriptSig, m_tx_out.scriptPubKey, witness, nFlags, CachingTransactionSignatureChecker(ptxTo, nIn, m_tx_out.nValue, cacheStore, *txdata), &error);
+    return VerifyScript(scriptSig, m_tx_out.scriptPubKey, witness, nFlags, CachingTransactionSignatureChecker(ptxTo, nIn, m_tx_out.nValue, cacheStore, *txdata, batch), &error);
+}
+
+bool RunChecks(std::vector<CScriptCheck>& checks)
+{
+    // Collecting the signatures only costs time if they are verified one by
+    // one anyway, and a failure would run all checks twice.
+    if (!BatchSchnorrVerifier::IsSupported()) {
+        return std::all_of(checks.begin(), checks.end(), [](CScriptCheck& check) { return check(); });
+    }
+    BatchSchnorrVerifier batch;
+    for (CScriptCheck& check : checks) {
+        if (!check(&batch)) return false;
+    }
+    if (batch.Verify()) return true;
+    for (CScriptCheck& check : checks) {
+        if (!check()) return false;
+    }
+    return true;
 }
 
 static CuckooCache::cache<uint256, SignatureCacheHasher> g_scriptExecutionCache;
 static CSHA256 g_scriptExecutionCacheHasher;
+static uint256 g_scriptExecutionCacheNonce;
 
-bool InitScriptExecutionCache(size_t max_size_bytes)
+static void SetScriptExecutionCacheNonce(const uint256& nonce)
 {
-    // Setup the salted hasher
-    uint256 nonce = GetRandHash();
+    g_scriptExecutionCacheNonce = nonce;
     // We want the nonce to be 64 bytes long to force the hasher to process
     // this chunk, which makes later hash computations more efficient. We
     // just write our 32-byte entropy twice to fill the 64 bytes.
+    g_scriptExecutionCacheHasher.Reset();
     g_scriptExecutionCacheHasher.Write(nonce.begin(), 32);
     g_scriptExecutionCacheHasher.Write(nonce.begin(), 32);
+}
+
+bool InitScriptExecutionCache(size_t max_size_bytes)
+{
+    // Setup the salted hasher
+    SetScriptExecutionCacheNonce(GetRandHash());
 
     auto setup_results = g_scriptExecutionCache.setup_bytes(max_size_bytes);
     if (!setup_results) return false;
@@ -1833,6 +1873,23 @@ bool InitScriptExecutionCache(size_t max_size_bytes)
     return true;
 }
 
+uint256 GetScriptExecutionCacheEntries(std::vector<uint256>& entries)
+{
+    AssertLockHeld(cs_main);
+    entries.clear();
+    g_scriptExecutionCache.for_each_live([&](const uint256& entry) { entries.push_back(entry); });
+    return g_scriptExecutionCacheNonce;
+}
+
+void LoadScriptExecutionCacheEntries(const uint256& nonce, const std::vector<uint256>& entries)
+{
+    AssertLockHeld(cs_main);
+    SetScriptExecutionCacheNonce(nonce);
+    for (const uint256& entry : entries) {
+        g_scriptExecutionCache.insert(entry);
+    }
+}
+
 /**
  * Check whether all of this transaction's input scripts succeed.
  *
@@ -1855,7 +1912,7 @@ bool InitScriptExecutionCache(size_t max_size_bytes)
 bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
                        const CCoinsViewCache& inputs, unsigned int flags, bool cacheSigStore,
                        bool cacheFullScriptStore, PrecomputedTransactionData& txdata,
-                       std::vector<CScriptCheck>* pvChecks)
+                       std::vector<CScriptCheck>* pvChecks, std::once_flag* txdata_once)
 {
     if (tx.IsCoinBase()) return true;
 
@@ -1886,7 +1943,9 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
             assert(!coin.IsSpent());
             spent_outputs.emplace_back(coin.out);
         }
-        txdata.Init(tx, std::move(spent_outputs));
+        // When the checks are queued, hashing the transaction is left to them
+        const bool defer_hashes{pvChecks && txdata_once};
+        txdata.Init(tx, std::move(spent_outputs), /*force=*/false, defer_hashes);
     }
     assert(txdata.m_spent_outputs.size() == tx.vin.size());
 
@@ -1899,7 +1958,7 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
         // spent being checked as a part of CScriptCheck.
 
         // Verify signature
-        CScriptCheck check(txdata.m_spent_outputs[i], tx, i, flags, cacheSigStore, &txdata);
+        CScriptCheck check(txdata.m_spent_outputs[i], tx, i, flags, cacheSigStore, &txdata, pvChecks ? txdata_once : nullptr);
         if (pvChecks) {
             pvChecks->emplace_back(std::move(check));
         } else if (!check()) {
@@ -2342,8 +2401,11 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     // in multiple threads). Preallocate the vector size so a new allocation
     // doesn't invalidate pointers into the vector, and keep txsdata in scope
     // for as long as `control`.
-    CCheckQueueControl<CScriptCheck> control(fScriptChecks && parallel_script_checks ? &scriptcheckqueue : nullptr);
+    // The script checks compute the transaction hashes in txsdata, guarded by
+    // txsdata_once, so this thread only gathers the spent outputs.
     std::vector<PrecomputedTransactionData> txsdata(block.vtx.size());
+    std::vector<std::once_flag> txsdata_once(block.vtx.size());
+    CCheckQueueControl<CScriptCheck> control(fScriptChecks && parallel_script_checks ? &scriptcheckqueue : nullptr);
 
     std::vector<int> prevheights;
     CAmount nFees = 0;
@@ -2401,7 +2463,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
             std::vector<CScriptCheck> vChecks;
             bool fCacheResults = fJustCheck; /* Don't cache results if we're actually connecting blocks (still consult the cache, though) */
             TxValidationState tx_state;
-            if (fScriptChecks && !CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], parallel_script_checks ? &vChecks : nullptr)) {
+            if (fScriptChecks && !CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], parallel_script_checks ? &vChecks : nullptr, &txsdata_once[i])) {
                 // Any transaction validation failure in ConnectBlock is a block consensus failure
                 state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
                               tx_state.GetRejectReason(), tx_state.GetDebugMessage());
@@ -2608,6 +2670,10 @@ bool Chainstate::FlushStateToDisk(
                 // TODO: Handle return error, or add detailed comment why it is
                 // safe to not return an error upon failure.
                 if (!m_blockman.FlushChainstateBlockFile(m_chain.Height())) {
+                    // The block index must not refer to data that was never written
+                    if (m_blockman.BlockWritesFailed()) {
+                        return state.Error("Failed to write block data to disk");
+                    }
                     LogPrintLevel(BCLog::VALIDATION, BCLog::Level::Warning, "%s: Failed to flush block file.\n", __func__);
                 }
             }
@@ -2888,11 +2954,18 @@ bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew,
     const auto time_1{SteadyClock::now()};
     std::shared_ptr<const CBlock> pthisBlock;
     if (!pblock) {
-        std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
-        if (!m_blockman.ReadBlockFromDisk(*pblockNew, *pindexNew)) {
-            return FatalError(m_chainman.GetNotifications(), state, "Failed to read block");
+        if (m_chainman.m_block_prefetcher) {
+            pthisBlock = m_chainman.m_block_prefetcher->Take(pindexNew->GetBlockHash());
+        }
+        if (pthisBlock) {
+            LogPrint(BCLog::BENCH, "  - Using prefetched block\n");
+        } else {
+            std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
+            if (!m_blockman.ReadBlockFromDisk(*pblockNew, *pindexNew)) {
+                return FatalError(m_chainman.GetNotifications(), state, "Failed to read block");
+            }
+            pthisBlock = pblockNew;
         }
-        pthisBlock = pblockNew;
     } else {
         LogPrint(BCLog::BENCH, "  - Using cached block\n");
         pthisBlock = pblock;
@@ -3095,6 +3168,24 @@ bool Chainstate::ActivateBestChainStep(BlockValidationState& state, CBlockIndex*
             vpindexToConnect.push_back(pindexIter);
             pindexIter = pindexIter->pprev;
         }
+
+        // Start loading the blocks on disk that are about to be connected,
+        // while the ones before them are being connected. Looking into the
+        // next step keeps the prefetcher busy when this one ends.
+        if (m_chainman.m_block_prefetcher) {
+            const int prefetch_height{std::min(nTargetHeight + m_chainman.m_options.block_prefetch, pindexMostWork->nHeight)};
+            std::vector<const CBlockIndex*> ahead;
+            for (const CBlockIndex* pindex{pindexMostWork->GetAncestor(prefetch_height)}; pindex && pindex->nHeight != nHeight; pindex = pindex->pprev) {
+                ahead.push_back(pindex);
+            }
+            std::vector<std::pair<const CBlockIndex*, FlatFilePos>> to_prefetch;
+            for (const CBlockIndex* pindex : reverse_iterate(ahead)) {
+                if (pindex == pindexMostWork && pblock) break;
+                if (!(pindex->nStatus & BLOCK_HAVE_DATA)) break;
+                to_prefetch.emplace_back(pindex, pindex->GetBlockPos());
+            }
+            m_chainman.m_block_prefetcher->Prefetch(to_prefetch);
+        }
         nHeight = nTargetHeight;
 
         // Connect new blocks.
@@ -3213,6 +3304,20 @@ bool Chainstate::ActivateBestChain(BlockValidationState& state, std::shared_ptr<
         // probably have a DEBUG_LOCKORDER test for this in the future.
         LimitValidationInterfaceQueue();
 
+        // Read the undo data of the blocks a reorg to the best candidate tip
+        // disconnects before taking cs_main for the reorg.
+        std::vector<const CBlockIndex*> to_disconnect;
+        {
+            LOCK(cs_main);
+            if (!setBlockIndexCandidates.empty()) {
+                const CBlockIndex* fork{m_chain.FindFork(*setBlockIndexCandidates.rbegin())};
+                for (const CBlockIndex* pindex{m_chain.Tip()}; fork && pindex && pindex != fork; pindex = pindex->pprev) {
+                    to_disconnect.push_back(pindex);
+                }
+            }
+        }
+        m_blockman.PrefetchUndo(to_disconnect);
+
         {
             LOCK(cs_main);
             // Lock transaction pool for at least as long as it takes for connectTrace to be consumed
@@ -3621,6 +3726,132 @@ static bool CheckBlockHeader(const CBlockHeader& block, BlockValidationState& st
     return true;
 }
 
+namespace {
+/**
+ * Threads that help the callers of ForEachBlockTransaction. They are started
+ * on first use and wait for the next block in between, so only the first
+ * large block pays for creating them. They serve one caller at a time; a
+ * concurrent caller (net_processing, the block prefetcher, ...) runs its loop
+ * on its own thread instead of waiting.
+ */
+class BlockTxWorkers
+{
+public:
+    explicit BlockTxWorkers(size_t num_threads)
+    {
+        try {
+            for (size_t n{0}; n < num_threads; ++n) {
+                m_threads.emplace_back(&util::TraceThread, strprintf("blockcheck.%i", n), [this] { ThreadWork(); });
+            }
+        } catch (const std::system_error& e) {
+            // Run with the threads that could be started, possibly none
+            LogPrintf("Failed to start block check thread: %s\n", e.what());
+        }
+    }
+
+    ~BlockTxWorkers()
+    {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_work_cv.notify_all();
+        for (std::thread& thread : m_threads) thread.join();
+    }
+
+    /**
+     * Run work on the calling thread and on every worker, and return once all
+     * of them are done with it. work must not throw. Returns false without
+     * running it if another caller is using the workers.
+     */
+    bool Run(const std::function<void()>& work) EXCLUSIVE_LOCKS_REQUIRED(!m_run_mutex, !m_mutex)
+    {
+        TRY_LOCK(m_run_mutex, run_lock);
+        if (!run_lock) return false;
+        {
+            LOCK(m_mutex);
+            m_work = &work;
+            ++m_work_id;
+            m_busy = m_threads.size();
+        }
+        m_work_cv.notify_all();
+        work();
+        WAIT_LOCK(m_mutex, lock);
+        m_done_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_busy == 0; });
+        m_work = nullptr;
+        return true;
+    }
+
+private:
+    //! Held by the caller of Run() for its duration.
+    Mutex m_run_mutex;
+    Mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_done_cv;
+    const std::function<void()>* m_work GUARDED_BY(m_mutex){nullptr};
+    uint64_t m_work_id GUARDED_BY(m_mutex){0};
+    //! Number of workers that have not finished m_work yet.
+    size_t m_busy GUARDED_BY(m_mutex){0};
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_threads;
+
+    void ThreadWork() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        uint64_t done_id{0};
+        WAIT_LOCK(m_mutex, lock);
+        while (true) {
+            m_work_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || m_work_id != done_id; });
+            if (m_stop) return;
+            done_id = m_work_id;
+            const std::function<void()>& work{*m_work};
+            {
+                REVERSE_LOCK(lock);
+                work();
+            }
+            if (--m_busy == 0) m_done_cv.notify_one();
+        }
+    }
+};
+
+BlockTxWorkers& GetBlockTxWorkers()
+{
+    static BlockTxWorkers workers{std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_BLOCK_CHECK_THREADS) - 1};
+    return workers;
+}
+} // namespace
+
+/**
+ * Call fn for each transaction index of a block, on several threads for large
+ * blocks. An exception thrown by fn stops the loop and is rethrown here.
+ */
+template <typename Fn>
+static void ForEachBlockTransaction(size_t num_txs, Fn fn)
+{
+    if (num_txs < MIN_PARALLEL_BLOCK_TXS) {
+        for (size_t i{0}; i < num_txs; ++i) fn(i);
+        return;
+    }
+    std::atomic<size_t> next{0};
+    Mutex error_mutex;
+    std::exception_ptr error;
+    const std::function<void()> run{[&] {
+        try {
+            for (size_t i{next++}; i < num_txs; i = next++) {
+                fn(i);
+            }
+        } catch (...) {
+            next = num_txs;
+            LOCK(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    }};
+    if (!GetBlockTxWorkers().Run(run)) run();
+    if (error) std::rethrow_exception(error);
+}
+
+void MakeBlockTransactions(std::vector<CMutableTransaction>&& txs, std::vector<CTransactionRef>& vtx)
+{
+    vtx.resize(txs.size());
+    ForEachBlockTransaction(txs.size(), [&](size_t i) { vtx[i] = MakeTransactionRef(std::move(txs[i])); });
+}
+
 bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW, bool fCheckMerkleRoot)
 {
     // These are checks that are independent of context.
@@ -3638,10 +3869,17 @@ bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensu
         return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "bad-signet-blksig", "signet block signature validation failure");
     }
 
-    // Check the merkle root.
+    // Check the merkle root. If the block commits to witness data, compute
+    // the witness merkle root along with it for ContextualCheckBlock.
+    std::optional<uint256> witness_merkle_root;
     if (fCheckMerkleRoot) {
         bool mutated;
-        uint256 hashMerkleRoot2 = BlockMerkleRoot(block, &mutated);
+        uint256 hashMerkleRoot2;
+        if (GetWitnessCommitmentIndex(block) != NO_WITNESS_COMMITMENT) {
+            std::tie(hashMerkleRoot2, witness_merkle_root) = BlockMerkleRoots(block, &mutated);
+        } else {
+            hashMerkleRoot2 = BlockMerkleRoot(block, &mutated);
+        }
         if (block.hashMerkleRoot != hashMerkleRoot2)
             return state.Invalid(BlockValidationResult::BLOCK_MUTATED, "bad-txnmrklroot", "hashMerkleRoot mismatch");
 
@@ -3671,24 +3909,34 @@ bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensu
 
     // Check transactions
     // Must check for duplicate inputs (see CVE-2018-17144)
-    for (const auto& tx : block.vtx) {
+    // Large blocks are checked on several threads, keeping track of the first
+    // invalid transaction so that the same error is reported either way.
+    std::atomic<size_t> first_invalid{block.vtx.size()};
+    std::atomic<unsigned int> nSigOps{0};
+    ForEachBlockTransaction(block.vtx.size(), [&](size_t i) {
+        size_t invalid{first_invalid.load()};
+        if (i > invalid) return;
         TxValidationState tx_state;
-        if (!CheckTransaction(*tx, tx_state)) {
-            // CheckBlock() does context-free validation checks. The only
-            // possible failures are consensus failures.
-            assert(tx_state.GetResult() == TxValidationResult::TX_CONSENSUS);
-            return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, tx_state.GetRejectReason(),
-                                 strprintf("Transaction check failed (tx hash %s) %s", tx->GetHash().ToString(), tx_state.GetDebugMessage()));
-        }
-    }
-    unsigned int nSigOps = 0;
-    for (const auto& tx : block.vtx)
-    {
-        nSigOps += GetLegacySigOpCount(*tx);
+        if (!CheckTransaction(*block.vtx[i], tx_state)) {
+            while (i < invalid && !first_invalid.compare_exchange_weak(invalid, i)) {}
+            return;
+        }
+        nSigOps += GetLegacySigOpCount(*block.vtx[i]);
+    });
+    if (first_invalid < block.vtx.size()) {
+        const CTransaction& tx{*block.vtx[first_invalid]};
+        TxValidationState tx_state;
+        CheckTransaction(tx, tx_state);
+        // CheckBlock() does context-free validation checks. The only
+        // possible failures are consensus failures.
+        assert(tx_state.GetResult() == TxValidationResult::TX_CONSENSUS);
+        return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, tx_state.GetRejectReason(),
+                             strprintf("Transaction check failed (tx hash %s) %s", tx.GetHash().ToString(), tx_state.GetDebugMessage()));
     }
     if (nSigOps * WITNESS_SCALE_FACTOR > MAX_BLOCK_SIGOPS_COST)
         return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "bad-blk-sigops", "out-of-bounds SigOpCount");
 
+    if (fCheckMerkleRoot) block.m_witness_merkle_root = witness_merkle_root;
     if (fCheckPOW && fCheckMerkleRoot)
         block.fChecked = true;
 
@@ -3853,7 +4101,7 @@ static bool ContextualCheckBlock(const CBlock& block, BlockValidationState& stat
         int commitpos = GetWitnessCommitmentIndex(block);
         if (commitpos != NO_WITNESS_COMMITMENT) {
             bool malleated = false;
-            uint256 hashWitness = BlockWitnessMerkleRoot(block, &malleated);
+            uint256 hashWitness = block.m_witness_merkle_root ? *block.m_witness_merkle_root : BlockWitnessMerkleRoot(block, &malleated);
             // The malleation check is ignored; as the transaction tree itself
             // already does not permit it, it is impossible to trigger in the
             // witness tree.
@@ -4635,7 +4883,7 @@ void ChainstateManager::LoadExternalBlockFile(
 
     int nLoaded = 0;
     try {
-        BufferedFile blkdat{file_in, 2 * MAX_BLOCK_SERIALIZED_SIZE, MAX_BLOCK_SERIALIZED_SIZE + 8};
+        BufferedFile blkdat{file_in, m_options.loadblock_buffer_bytes, MAX_BLOCK_SERIALIZED_SIZE + 8};
         // nRewind indicates where to resume scanning in case something goes wrong,
         // such as a block fails to deserialize.
         uint64_t nRewind = blkdat.GetPos();
@@ -4646,10 +4894,11 @@ void ChainstateManager::LoadExternalBlockFile(
             nRewind++; // start one byte further next time, in case of failure
             blkdat.SetLimit(); // remove former limit
             unsigned int nSize = 0;
+            bool compressed{false};
             try {
                 // locate a header
                 MessageStartChars buf;
-                blkdat.FindByte(std::byte(params.MessageStart()[0]));
+                blkdat.FindBytes(MakeByteSpan(params.MessageStart()));
                 nRewind = blkdat.GetPos() + 1;
                 blkdat >> buf;
                 if (buf != params.MessageStart()) {
@@ -4657,6 +4906,8 @@ void ChainstateManager::LoadExternalBlockFile(
                 }
                 // read size
                 blkdat >> nSize;
+                compressed = (nSize & node::BLOCK_COMPRESSED_FLAG) != 0;
+                nSize &= ~node::BLOCK_COMPRESSED_FLAG;
                 if (nSize < 80 || nSize > MAX_BLOCK_SERIALIZED_SIZE)
                     continue;
             } catch (const std::exception&) {
@@ -4672,112 +4923,25 @@ void ChainstateManager::LoadExternalBlockFile(
                 blkdat.SetLimit(nBlockPos + nSize);
                 CBlockHeader header;
                 blkdat >> header;
-                const uint256 hash{header.GetHash()};
                 // Skip the rest of this block (this may read from disk into memory); position to the marker before the
                 // next block, but it's still possible to rewind to the start of the current block (without a disk read).
                 nRewind = nBlockPos + nSize;
                 blkdat.SkipTo(nRewind);
 
-                std::shared_ptr<CBlock> pblock{}; // needs to remain available after the cs_main lock is released to avoid duplicate reads from disk
-
-                {
-                    LOCK(cs_main);
-                    // detect out of order blocks, and store them for later
-                    if (hash != params.GetConsensus().hashGenesisBlock && !m_blockman.LookupBlockIndex(header.hashPrevBlock)) {
-                        LogPrint(BCLog::REINDEX, "%s: Out of order block %s, parent %s not known\n", __func__, hash.ToString(),
-                                 header.hashPrevBlock.ToString());
-                        if (dbp && blocks_with_unknown_parent) {
-                            blocks_with_unknown_parent->emplace(header.hashPrevBlock, *dbp);
-                        }
-                        continue;
-                    }
-
-                    // process in case the block isn't known yet
-                    const CBlockIndex* pindex = m_blockman.LookupBlockIndex(hash);
-                    if (!pindex || (pindex->nStatus & BLOCK_HAVE_DATA) == 0) {
-                        // This block can be processed immediately; rewind to its start, read and deserialize it.
-                        blkdat.SetPos(nBlockPos);
-                        pblock = std::make_shared<CBlock>();
-                        blkdat >> *pblock;
-                        nRewind = blkdat.GetPos();
-
-                        BlockValidationState state;
-                        if (AcceptBlock(pblock, state, nullptr, true, dbp, nullptr, true)) {
-                            nLoaded++;
-                        }
-                        if (state.IsError()) {
-                            break;
-                        }
-                    } else if (hash != params.GetConsensus().hashGenesisBlock && pindex->nHeight % 1000 == 0) {
-                        LogPrint(BCLog::REINDEX, "Block Import: already had block %s at height %d\n", hash.ToString(), pindex->nHeight);
-                    }
-                }
-
-                // Activate the genesis block so normal node progress can continue
-                if (hash == params.GetConsensus().hashGenesisBlock) {
-                    bool genesis_activation_failure = false;
-                    for (auto c : GetAll()) {
-                        BlockValidationState state;
-                        if (!c->ActivateBestChain(state, nullptr)) {
-                            genesis_activation_failure = true;
-                            break;
-                        }
-                    }
-                    if (genesis_activation_failure) {
-                        break;
-                    }
-                }
-
-                if (m_blockman.IsPruneMode() && !fReindex && pblock) {
-                    // must update the tip for pruning to work while importing with -loadblock.
-                    // this is a tradeoff to conserve disk space at the expense of time
-                    // spent updating the tip to be able to prune.
-                    // otherwise, ActivateBestChain won't be called by the import process
-                    // until after all of the block files are loaded. ActivateBestChain can be
-                    // called by concurrent network message processing. but, that is not
-                    // reliable for the purpose of pruning while importing.
-                    bool activation_failure = false;
-                    for (auto c : GetAll()) {
-                        BlockValidationState state;
-                        if (!c->ActivateBestChain(state, pblock)) {
-                            LogPrint(BCLog::REINDEX, "failed to activate chain (%s)\n", state.ToString());
-                            activation_failure = true;
-                            break;
-                        }
-                    }
-                    if (activation_failure) {
-                        break;
-                    }
-                }
-
-                NotifyHeaderTip(*this);
-
-                if (!blocks_with_unknown_parent) continue;
-
-                // Recursively process earlier encountered successors of this block
-                std::deque<uint256> queue;
-                queue.push_back(hash);
-                while (!queue.empty()) {
-                    uint256 head = queue.front();
-                    queue.pop_front();
-                    auto range = blocks_with_unknown_parent->equal_range(head);
-                    while (range.first != range.second) {
-                        std::multimap<uint256, FlatFilePos>::iterator it = range.first;
-                        std::shared_ptr<CBlock> pblockrecursive = std::make_shared<CBlock>();
-                        if (m_blockman.ReadBlockFromDisk(*pblockrecursive, it->second)) {
-                            LogPrint(BCLog::REINDEX, "%s: Processing out of order child %s of %s\n", __func__, pblockrecursive->GetHash().ToString(),
-                                    head.ToString());
-                            LOCK(cs_main);
-                            BlockValidationState dummy;
-                            if (AcceptBlock(pblockrecursive, dummy, nullptr, true, &it->second, nullptr, true)) {
-                                nLoaded++;
-                                queue.push_back(pblockrecursive->GetHash());
-                            }
-                        }
-                        range.first++;
-                        blocks_with_unknown_parent->erase(it);
-                        NotifyHeaderTip(*this);
+                const auto read_block{[&] {
+                    // Rewind to the start of the block, and read and deserialize it.
+                    blkdat.SetPos(nBlockPos);
+                    auto pblock{std::make_shared<CBlock>()};
+                    if (compressed) {
+                        blkdat >> Using<BlockCompression>(*pblock);
+                    } else {
+                        UnserializeBlock(blkdat, *pblock);
                     }
+                    nRewind = blkdat.GetPos();
+                    return pblock;
+                }};
+                if (!ProcessExternalBlock(header, header.GetHash(), read_block, dbp, blocks_with_unknown_parent, nLoaded)) {
+                    break;
                 }
             } catch (const std::exception& e) {
                 // historical bugs added extra data to the block files that does not deserialize cleanly.
@@ -4800,6 +4964,202 @@ void ChainstateManager::LoadExternalBlockFile(
     LogPrintf("Loaded %i blocks from external file in %dms\n", nLoaded, Ticks<std::chrono::milliseconds>(SteadyClock::now() - start));
 }
 
+bool ChainstateManager::ProcessExternalBlock(
+    const CBlockHeader& header,
+    const uint256& hash,
+    const std::function<std::shared_ptr<CBlock>()>& read_block,
+    FlatFilePos* dbp,
+    std::multimap<uint256, FlatFilePos>* blocks_with_unknown_parent,
+    int& loaded)
+{
+    const CChainParams& params{GetParams()};
+
+    std::shared_ptr<CBlock> pblock{}; // needs to remain available after the cs_main lock is released to avoid duplicate reads from disk
+
+    {
+        LOCK(cs_main);
+        // detect out of order blocks, and store them for later
+        if (hash != params.GetConsensus().hashGenesisBlock && !m_blockman.LookupBlockIndex(header.hashPrevBlock)) {
+            LogPrint(BCLog::REINDEX, "%s: Out of order block %s, parent %s not known\n", __func__, hash.ToString(),
+                     header.hashPrevBlock.ToString());
+            if (dbp && blocks_with_unknown_parent) {
+                blocks_with_unknown_parent->emplace(header.hashPrevBlock, *dbp);
+            }
+            return true;
+        }
+
+        // process in case the block isn't known yet
+        const CBlockIndex* pindex = m_blockman.LookupBlockIndex(hash);
+        if (!pindex || (pindex->nStatus & BLOCK_HAVE_DATA) == 0) {
+            // This block can be processed immediately
+            pblock = read_block();
+            if (!pblock) return true;
+
+            BlockValidationState state;
+            if (AcceptBlock(pblock, state, nullptr, true, dbp, nullptr, true)) {
+                loaded++;
+            }
+            if (state.IsError()) {
+                return false;
+            }
+        } else if (hash != params.GetConsensus().hashGenesisBlock && pindex->nHeight % 1000 == 0) {
+            LogPrint(BCLog::REINDEX, "Block Import: already had block %s at height %d\n", hash.ToString(), pindex->nHeight);
+        }
+    }
+
+    // Activate the genesis block so normal node progress can continue
+    if (hash == params.GetConsensus().hashGenesisBlock) {
+        bool genesis_activation_failure = false;
+        for (auto c : GetAll()) {
+            BlockValidationState state;
+            if (!c->ActivateBestChain(state, nullptr)) {
+                genesis_activation_failure = true;
+                break;
+            }
+        }
+        if (genesis_activation_failure) {
+            return false;
+        }
+    }
+
+    if (m_blockman.IsPruneMode() && !fReindex && pblock) {
+        // must update the tip for pruning to work while importing with -loadblock.
+        // this is a tradeoff to conserve disk space at the expense of time
+        // spent updating the tip to be able to prune.
+        // otherwise, ActivateBestChain won't be called by the import process
+        // until after all of the block files are loaded. ActivateBestChain can be
+        // called by concurrent network message processing. but, that is not
+        // reliable for the purpose of pruning while importing.
+        bool activation_failure = false;
+        for (auto c : GetAll()) {
+            BlockValidationState state;
+            if (!c->ActivateBestChain(state, pblock)) {
+                LogPrint(BCLog::REINDEX, "failed to activate chain (%s)\n", state.ToString());
+                activation_failure = true;
+                break;
+            }
+        }
+        if (activation_failure) {
+            return false;
+        }
+    }
+
+    NotifyHeaderTip(*this);
+
+    if (!blocks_with_unknown_parent) return true;
+
+    // Recursively process earlier encountered successors of this block
+    std::deque<uint256> queue;
+    queue.push_back(hash);
+    while (!queue.empty()) {
+        uint256 head = queue.front();
+        queue.pop_front();
+        auto range = blocks_with_unknown_parent->equal_range(head);
+        while (range.first != range.second) {
+            std::multimap<uint256, FlatFilePos>::iterator it = range.first;
+            std::shared_ptr<CBlock> pblockrecursive = std::make_shared<CBlock>();
+            if (m_blockman.ReadBlockFromDisk(*pblockrecursive, it->second)) {
+                LogPrint(BCLog::REINDEX, "%s: Processing out of order child %s of %s\n", __func__, pblockrecursive->GetHash().ToString(),
+                        head.ToString());
+                LOCK(cs_main);
+                BlockValidationState dummy;
+                if (AcceptBlock(pblockrecursive, dummy, nullptr, true, &it->second, nullptr, true)) {
+                    loaded++;
+                    queue.push_back(pblockrecursive->GetHash());
+                }
+            }
+            range.first++;
+            blocks_with_unknown_parent->erase(it);
+            NotifyHeaderTip(*this);
+        }
+    }
+    return true;
+}
+
+std::vector<BlockFileRecord> ChainstateManager::ScanBlockFile(CAutoFile& file_in, int file_num) const
+{
+    const CChainParams& params{GetParams()};
+
+    std::vector<BlockFileRecord> records;
+    try {
+        BufferedFile blkdat{file_in, 2 * MAX_BLOCK_SERIALIZED_SIZE, MAX_BLOCK_SERIALIZED_SIZE + 8};
+        // Same scan as in LoadExternalBlockFile, without processing the blocks.
+        uint64_t nRewind = blkdat.GetPos();
+        while (!blkdat.eof()) {
+            if (m_interrupt) break;
+
+            blkdat.SetPos(nRewind);
+            nRewind++; // start one byte further next time, in case of failure
+            blkdat.SetLimit(); // remove former limit
+            unsigned int nSize = 0;
+            bool compressed{false};
+            try {
+                // locate a header
+                MessageStartChars buf;
+                blkdat.FindBytes(MakeByteSpan(params.MessageStart()));
+                nRewind = blkdat.GetPos() + 1;
+                blkdat >> buf;
+                if (buf != params.MessageStart()) {
+                    continue;
+                }
+                // read size
+                blkdat >> nSize;
+                compressed = (nSize & node::BLOCK_COMPRESSED_FLAG) != 0;
+                nSize &= ~node::BLOCK_COMPRESSED_FLAG;
+                if (nSize < 80 || nSize > MAX_BLOCK_SERIALIZED_SIZE)
+                    continue;
+            } catch (const std::exception&) {
+                // no valid block header found; don't complain
+                // (this happens at the end of every blk.dat file)
+                break;
+            }
+            try {
+                // read the block, and compute its hash here rather than on
+                // the import thread
+                const uint64_t nBlockPos{blkdat.GetPos()};
+                blkdat.SetLimit(nBlockPos + nSize);
+                auto pblock{std::make_shared<CBlock>()};
+                if (compressed) {
+                    blkdat >> Using<BlockCompression>(*pblock);
+                } else {
+                    UnserializeBlock(blkdat, *pblock);
+                }
+                nRewind = blkdat.GetPos();
+                const uint256 hash{pblock->GetHash()};
+                records.push_back({FlatFilePos{file_num, static_cast<unsigned int>(nBlockPos)}, std::move(pblock), hash});
+            } catch (const std::exception& e) {
+                LogPrint(BCLog::REINDEX, "%s: unexpected data at file offset 0x%x - %s. continuing\n", __func__, (nRewind - 1), e.what());
+            }
+        }
+    } catch (const std::runtime_error& e) {
+        GetNotifications().fatalError(std::string("System error: ") + e.what());
+    }
+    return records;
+}
+
+void ChainstateManager::LoadBlockFileRecords(
+    std::vector<BlockFileRecord> records,
+    std::multimap<uint256, FlatFilePos>& blocks_with_unknown_parent)
+{
+    const auto start{SteadyClock::now()};
+
+    int nLoaded = 0;
+    for (BlockFileRecord& record : records) {
+        if (m_interrupt) return;
+
+        FlatFilePos pos{record.pos};
+        try {
+            const auto read_block{[&] { return record.block; }};
+            const bool keep_going{ProcessExternalBlock(*record.block, record.hash, read_block, &pos, &blocks_with_unknown_parent, nLoaded)};
+            record.block.reset();
+            if (!keep_going) break;
+        } catch (const std::exception& e) {
+            LogPrint(BCLog::REINDEX, "%s: unexpected data at %s - %s. continuing\n", __func__, pos.ToString(), e.what());
+        }
+    }
+    LogPrintf("Loaded %i blocks from block file in %dms\n", nLoaded, Ticks<std::chrono::milliseconds>(SteadyClock::now() - start));
+}
+
 void ChainstateManager::CheckBlockIndex()
 {
     if (!ShouldCheckBlockIndex()) {
@@ -5335,6 +5695,253 @@ static void SnapshotUTXOHashBreakpoint(const util::SignalInterrupt& interrupt)
     if (interrupt) throw StopHashingException();
 }
 
+namespace {
+/**
+ * Deserializes, checks and hashes the coins of a UTXO snapshot on a separate
+ * thread, so that reading the file overlaps with loading earlier coins into
+ * the coins cache and flushing them to disk.
+ *
+ * Snapshots are written in coins database order, so hashing the coins in file
+ * order yields the HASH_SERIALIZED value ComputeUTXOStats() would compute over
+ * the loaded database, without having to read it back. A file that is not in
+ * that order cannot match the assumeutxo hash and is rejected early.
+ */
+class SnapshotCoinsReader
+{
+public:
+    using Batch = std::vector<std::pair<COutPoint, Coin>>;
+
+    SnapshotCoinsReader(AutoFile& coins_file, const SnapshotMetadata& metadata, int base_height)
+        : m_file{coins_file}, m_metadata{metadata}, m_coins_count{metadata.m_coins_count}, m_base_height{base_height}
+    {
+        m_thread = std::thread([this] {
+            util::ThreadRename("loadsnapshot");
+            try {
+                Loop();
+            } catch (const std::exception& e) {
+                LogPrintf("[snapshot] error reading snapshot after deserializing %d coins: %s\n",
+                          m_coins_read, e.what());
+                WITH_LOCK(m_mutex, m_exception = std::current_exception());
+                Finish(std::nullopt);
+            }
+        });
+    }
+
+    ~SnapshotCoinsReader()
+    {
+        WITH_LOCK(m_mutex, m_request_stop = true);
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    //! Return the next batch of coins, or nullopt once the whole file was read
+    //! or reading it failed.
+    std::optional<Batch> Next() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        std::optional<Batch> batch;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return !m_queue.empty() || m_done; });
+            if (m_queue.empty()) return std::nullopt;
+            batch = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        m_cv.notify_all();
+        return batch;
+    }
+
+    //! Once Next() returned nullopt: the hash of all coins if the snapshot was
+    //! read and checked successfully, nullopt otherwise. Rethrows an unexpected
+    //! exception of the reading thread.
+    std::optional<uint256> Result() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        if (m_exception) std::rethrow_exception(m_exception);
+        return m_result;
+    }
+
+private:
+    //! Number of coins per batch handed to the loading thread.
+    static constexpr size_t BATCH_SIZE{10000};
+    //! Maximum number of batches read ahead of the loading thread.
+    static constexpr size_t MAX_QUEUED_BATCHES{8};
+
+    AutoFile& m_file;
+    const SnapshotMetadata& m_metadata;
+    const uint64_t m_coins_count;
+    const int m_base_height;
+
+    HashWriter m_hasher{};
+    COutPoint m_prev_outpoint;
+    uint64_t m_coins_read{0};
+    Batch m_batch;
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Batch> m_queue GUARDED_BY(m_mutex);
+    bool m_done GUARDED_BY(m_mutex){false};
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+    std::optional<uint256> m_result GUARDED_BY(m_mutex);
+    std::exception_ptr m_exception GUARDED_BY(m_mutex);
+    std::thread m_thread;
+
+    //! Queue a batch, waiting for room. Returns false if asked to stop.
+    bool Push(Batch& batch) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_queue.size() < MAX_QUEUED_BATCHES || m_request_stop; });
+            if (m_request_stop) return false;
+            m_queue.push_back(std::move(batch));
+        }
+        m_cv.notify_all();
+        batch.clear();
+        return true;
+    }
+
+    void Finish(std::optional<uint256> result) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        {
+            LOCK(m_mutex);
+            m_result = result;
+            m_done = true;
+        }
+        m_cv.notify_all();
+    }
+
+    //! Check a coin and hash it. Returns false if the snapshot is invalid.
+    bool CheckCoin(const COutPoint& outpoint, const Coin& coin)
+    {
+        if (coin.nHeight > m_base_height ||
+            outpoint.n >= std::numeric_limits<decltype(outpoint.n)>::max() // Avoid integer wrap-around in coinstats.cpp:ApplyHash
+        ) {
+            LogPrintf("[snapshot] bad snapshot data after deserializing %d coins\n",
+                      m_coins_read);
+            return false;
+        }
+        if (!MoneyRange(coin.out.nValue)) {
+            LogPrintf("[snapshot] bad snapshot data after deserializing %d coins - bad tx out value\n",
+                      m_coins_read);
+            return false;
+        }
+        if (m_coins_read > 0 && !CoinsDBKeyLess(m_prev_outpoint, outpoint)) {
+            LogPrintf("[snapshot] bad snapshot - coins not in database order after deserializing %d coins\n",
+                      m_coins_read);
+            return false;
+        }
+        kernel::ApplyCoinHash(m_hasher, outpoint, coin);
+        m_prev_outpoint = outpoint;
+        return true;
+    }
+
+    //! Read the outpoint/coin pairs of a version 1 snapshot.
+    //! Returns false if the snapshot is invalid or we were asked to stop.
+    bool ReadFlat() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        COutPoint outpoint;
+        Coin coin;
+        for (; m_coins_read < m_coins_count; ++m_coins_read) {
+            try {
+                m_file >> outpoint;
+                m_file >> coin;
+            } catch (const std::ios_base::failure&) {
+                LogPrintf("[snapshot] bad snapshot format or truncated snapshot after deserializing %d coins\n",
+                          m_coins_read);
+                return false;
+            }
+            if (!CheckCoin(outpoint, coin)) return false;
+            m_batch.emplace_back(std::move(outpoint), std::move(coin));
+            if (m_batch.size() >= BATCH_SIZE && !Push(m_batch)) return false;
+        }
+        return true;
+    }
+
+    //! Read the chunks and chunk index of a version 2 snapshot. Each chunk is
+    //! verified against its checksum before any of its coins are loaded.
+    //! Returns false if the snapshot is invalid or we were asked to stop.
+    bool ReadChunked() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        std::vector<SnapshotChunkInfo> chunks;
+        uint64_t offset{GetSerializeSize(m_metadata, CLIENT_VERSION)};
+        Batch chunk_coins;
+        while (m_coins_read < m_coins_count) {
+            chunk_coins.clear();
+            uint64_t chunk_size;
+            try {
+                chunk_size = ReadSnapshotChunk(m_file, chunk_coins);
+            } catch (const std::ios_base::failure& e) {
+                LogPrintf("[snapshot] bad snapshot chunk after deserializing %d coins: %s\n",
+                          m_coins_read, e.what());
+                return false;
+            }
+            if (chunk_coins.empty()) {
+                LogPrintf("[snapshot] bad snapshot - empty chunk after deserializing %d coins\n",
+                          m_coins_read);
+                return false;
+            }
+            if (chunk_coins.size() > m_coins_count - m_coins_read) {
+                LogPrintf("[snapshot] bad snapshot - chunk of %d coins exceeds the %d coins left after deserializing %d coins\n",
+                          chunk_coins.size(), m_coins_count - m_coins_read, m_coins_read);
+                return false;
+            }
+            chunks.push_back({offset, static_cast<uint32_t>(chunk_coins.size())});
+            offset += chunk_size;
+
+            for (auto& [outpoint, coin] : chunk_coins) {
+                if (!CheckCoin(outpoint, coin)) return false;
+                m_batch.emplace_back(std::move(outpoint), std::move(coin));
+                ++m_coins_read;
+                if (m_batch.size() >= BATCH_SIZE && !Push(m_batch)) return false;
+            }
+        }
+
+        std::vector<SnapshotChunkInfo> index;
+        uint64_t index_offset;
+        try {
+            m_file >> index >> index_offset;
+        } catch (const std::ios_base::failure&) {
+            LogPrintf("[snapshot] bad snapshot - missing chunk index after deserializing %d coins\n",
+                      m_coins_read);
+            return false;
+        }
+        const auto same_chunk{[](const SnapshotChunkInfo& a, const SnapshotChunkInfo& b) {
+            return a.m_offset == b.m_offset && a.m_coins_count == b.m_coins_count;
+        }};
+        if (index_offset != offset || !std::equal(index.begin(), index.end(), chunks.begin(), chunks.end(), same_chunk)) {
+            LogPrintf("[snapshot] bad snapshot - chunk index does not match chunks\n");
+            return false;
+        }
+        return true;
+    }
+
+    void Loop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        m_batch.reserve(BATCH_SIZE);
+        const bool read_ok{m_metadata.m_version == SNAPSHOT_VERSION_CHUNKED ? ReadChunked() : ReadFlat()};
+        if (!read_ok) {
+            return Finish(std::nullopt);
+        }
+        if (!m_batch.empty() && !Push(m_batch)) return Finish(std::nullopt);
+
+        bool out_of_coins{false};
+        try {
+            uint8_t byte;
+            m_file >> byte;
+        } catch (const std::ios_base::failure&) {
+            // We expect an exception since we should be out of coins.
+            out_of_coins = true;
+        }
+        if (!out_of_coins) {
+            LogPrintf("[snapshot] bad snapshot - coins left over after deserializing %d coins\n",
+                m_coins_count);
+            return Finish(std::nullopt);
+        }
+
+        Finish(m_hasher.GetHash());
+    }
+};
+} // namespace
+
 bool ChainstateManager::PopulateAndValidateSnapshot(
     Chainstate& snapshot_chainstate,
     AutoFile& coins_file,
@@ -5375,70 +5982,67 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
         return false;
     }
 
-    COutPoint outpoint;
-    Coin coin;
     const uint64_t coins_count = metadata.m_coins_count;
-    uint64_t coins_left = metadata.m_coins_count;
 
     LogPrintf("[snapshot] loading coins from snapshot %s\n", base_blockhash.ToString());
     int64_t coins_processed{0};
 
-    while (coins_left > 0) {
-        try {
-            coins_file >> outpoint;
-            coins_file >> coin;
-        } catch (const std::ios_base::failure&) {
-            LogPrintf("[snapshot] bad snapshot format or truncated snapshot after deserializing %d coins\n",
-                      coins_count - coins_left);
-            return false;
-        }
-        if (coin.nHeight > base_height ||
-            outpoint.n >= std::numeric_limits<decltype(outpoint.n)>::max() // Avoid integer wrap-around in coinstats.cpp:ApplyHash
-        ) {
-            LogPrintf("[snapshot] bad snapshot data after deserializing %d coins\n",
-                      coins_count - coins_left);
-            return false;
-        }
-        if (!MoneyRange(coin.out.nValue)) {
-            LogPrintf("[snapshot] bad snapshot data after deserializing %d coins - bad tx out value\n",
-                      coins_count - coins_left);
-            return false;
-        }
+    std::optional<uint256> snapshot_hash;
+    {
+        SnapshotCoinsReader reader{coins_file, metadata, base_height};
 
-        coins_cache.EmplaceCoinInternalDANGER(std::move(outpoint), std::move(coin));
+        while (auto batch{reader.Next()}) {
+            for (auto& [outpoint, coin] : *batch) {
+                coins_cache.EmplaceCoinInternalDANGER(std::move(outpoint), std::move(coin));
 
-        --coins_left;
-        ++coins_processed;
+                ++coins_processed;
 
-        if (coins_processed % 1000000 == 0) {
-            LogPrintf("[snapshot] %d coins loaded (%.2f%%, %.2f MB)\n",
-                coins_processed,
-                static_cast<float>(coins_processed) * 100 / static_cast<float>(coins_count),
-                coins_cache.DynamicMemoryUsage() / (1000 * 1000));
-        }
+                if (coins_processed % 1000000 == 0) {
+                    LogPrintf("[snapshot] %d coins loaded (%.2f%%, %.2f MB)\n",
+                        coins_processed,
+                        static_cast<float>(coins_processed) * 100 / static_cast<float>(coins_count),
+                        coins_cache.DynamicMemoryUsage() / (1000 * 1000));
+                }
 
-        // Batch write and flush (if we need to) every so often.
-        //
-        // If our average Coin size is roughly 41 bytes, checking every 120,000 coins
-        // means <5MB of memory imprecision.
-        if (coins_processed % 120000 == 0) {
-            if (m_interrupt) {
-                return false;
-            }
+                // Batch write and flush (if we need to) every so often.
+                //
+                // If our average Coin size is roughly 41 bytes, checking every 120,000 coins
+                // means <5MB of memory imprecision.
+                if (coins_processed % 120000 == 0) {
+                    if (m_interrupt) {
+                        return false;
+                    }
 
-            const auto snapshot_cache_state = WITH_LOCK(::cs_main,
-                return snapshot_chainstate.GetCoinsCacheSizeState());
+                    const auto snapshot_cache_state = WITH_LOCK(::cs_main,
+                        return snapshot_chainstate.GetCoinsCacheSizeState());
 
-            if (snapshot_cache_state >= CoinsCacheSizeState::CRITICAL) {
-                // This is a hack - we don't know what the actual best block is, but that
-                // doesn't matter for the purposes of flushing the cache here. We'll set this
-                // to its correct value (`base_blockhash`) below after the coins are loaded.
-                coins_cache.SetBestBlock(GetRandHash());
+                    if (snapshot_cache_state >= CoinsCacheSizeState::CRITICAL) {
+                        // This is a hack - we don't know what the actual best block is, but that
+                        // doesn't matter for the purposes of flushing the cache here. We'll set this
+                        // to its correct value (`base_blockhash`) below after the coins are loaded.
+                        coins_cache.SetBestBlock(GetRandHash());
 
-                // No need to acquire cs_main since this chainstate isn't being used yet.
-                FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/false);
+                        // No need to acquire cs_main since this chainstate isn't being used yet.
+                        FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/false);
+                    }
+                }
             }
         }
+
+        // The reader has logged the reason if the snapshot could not be read.
+        snapshot_hash = reader.Result();
+    }
+    if (!snapshot_hash) {
+        return false;
+    }
+
+    // Assert that the deserialized chainstate contents match the expected assumeutxo value.
+    // The hash was computed while reading the snapshot, see SnapshotCoinsReader,
+    // so there is no need to read the coins back from the database.
+    if (AssumeutxoHash{*snapshot_hash} != au_data.hash_serialized) {
+        LogPrintf("[snapshot] bad snapshot content hash: expected %s, got %s\n",
+            au_data.hash_serialized.ToString(), snapshot_hash->ToString());
+        return false;
     }
 
     // Important that we set this. This and the coins_cache accesses above are
@@ -5448,19 +6052,6 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
     // method.
     coins_cache.SetBestBlock(base_blockhash);
 
-    bool out_of_coins{false};
-    try {
-        coins_file >> outpoint;
-    } catch (const std::ios_base::failure&) {
-        // We expect an exception since we should be out of coins.
-        out_of_coins = true;
-    }
-    if (!out_of_coins) {
-        LogPrintf("[snapshot] bad snapshot - coins left over after deserializing %d coins\n",
-            coins_count);
-        return false;
-    }
-
     LogPrintf("[snapshot] loaded %d (%.2f MB) coins from snapshot %s\n",
         coins_count,
         coins_cache.DynamicMemoryUsage() / (1000 * 1000),
@@ -5471,30 +6062,6 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
 
     assert(coins_cache.GetBestBlock() == base_blockhash);
 
-    // As above, okay to immediately release cs_main here since no other context knows
-    // about the snapshot_chainstate.
-    CCoinsViewDB* snapshot_coinsdb = WITH_LOCK(::cs_main, return &snapshot_chainstate.CoinsDB());
-
-    std::optional<CCoinsStats> maybe_stats;
-
-    try {
-        maybe_stats = ComputeUTXOStats(
-            CoinStatsHashType::HASH_SERIALIZED, snapshot_coinsdb, m_blockman, [&interrupt = m_interrupt] { SnapshotUTXOHashBreakpoint(interrupt); });
-    } catch (StopHashingException const&) {
-        return false;
-    }
-    if (!maybe_stats.has_value()) {
-        LogPrintf("[snapshot] failed to generate coins stats\n");
-        return false;
-    }
-
-    // Assert that the deserialized chainstate contents match the expected assumeutxo value.
-    if (AssumeutxoHash{maybe_stats->hashSerialized} != au_data.hash_serialized) {
-        LogPrintf("[snapshot] bad snapshot content hash: expected %s, got %s\n",
-            au_data.hash_serialized.ToString(), maybe_stats->hashSerialized.ToString());
-        return false;
-    }
-
     snapshot_chainstate.m_chain.SetTip(*snapshot_start_block);
 
     // The remainder of this function requires modifying data protected by cs_main.
@@ -5768,10 +6335,35 @@ static ChainstateManager::Options&& Flatten(ChainstateManager::Options&& opts)
 ChainstateManager::ChainstateManager(const util::SignalInterrupt& interrupt, Options options, node::BlockManager::Options blockman_options)
     : m_interrupt{interrupt},
       m_options{Flatten(std::move(options))},
-      m_blockman{interrupt, std::move(blockman_options)} {}
+      m_blockman{interrupt, std::move(blockman_options)}
+{
+    if (m_options.block_prefetch > 0) {
+        m_block_prefetcher = std::make_unique<node::BlockPrefetcher>(
+            [this](const CBlockIndex& index, const FlatFilePos& pos) -> std::shared_ptr<const CBlock> {
+                // The header is compared with the index rather than hashed:
+                // the proof-of-work hash is slow and computed under a global
+                // lock, so it would serialize the prefetch threads.
+                auto block{std::make_shared<CBlock>()};
+                if (!m_blockman.ReadBlockFromDisk(*block, pos, index)) return nullptr;
+                // Run the remaining context-free checks now, and mark the
+                // block as checked so ConnectBlock does not repeat them. The
+                // proof of work was checked with the header of the index.
+                // Failures are left for ConnectBlock to find and report.
+                BlockValidationState state;
+                if (CheckBlock(*block, state, GetConsensus(), /*fCheckPOW=*/false)) {
+                    block->fChecked = true;
+                }
+                return block;
+            },
+            std::min(m_options.block_prefetch, node::MAX_BLOCK_PREFETCH_THREADS), m_options.block_prefetch);
+    }
+}
 
 ChainstateManager::~ChainstateManager()
 {
+    // Stop the prefetch threads before the block manager they read from goes away
+    m_block_prefetcher.reset();
+
     LOCK(::cs_main);
 
     m_versionbitscache.Clear();
@@ -36,8 +36,10 @@
 #include <versionbits.h>
 
 #include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <stdint.h>
@@ -47,6 +49,7 @@
 #include <utility>
 #include <vector>
 
+class BatchSchnorrVerifier;
 class Chainstate;
 class CTxMemPool;
 class ChainstateManager;
@@ -56,6 +59,7 @@ struct PrecomputedTransactionData;
 struct LockPoints;
 struct AssumeutxoData;
 namespace node {
+class BlockPrefetcher;
 class SnapshotMetadata;
 } // namespace node
 namespace Consensus {
@@ -65,10 +69,18 @@ namespace util {
 class SignalInterrupt;
 } // namespace util
 
-/** Maximum number of dedicated script-checking threads allowed */
-static const int MAX_SCRIPTCHECK_THREADS = 15;
+/** Maximum number of dedicated script-checking threads allowed, as a sanity limit on -par */
+static const int MAX_SCRIPTCHECK_THREADS = 256;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/**
+ * Blocks with at least this many transactions are deserialized and checked on
+ * several threads. Hashing and checking a typical transaction takes about
+ * 1.3us, so below this the work is too short to be worth waking the workers.
+ */
+static constexpr size_t MIN_PARALLEL_BLOCK_TXS{256};
+/** The maximum number of threads, including the calling one, deserializing or checking a block */
+static constexpr size_t MAX_BLOCK_CHECK_THREADS{4};
 /** Block files containing a block-height within MIN_BLOCKS_TO_KEEP of ActiveChain().Tip() will not be pruned. */
 static const unsigned int MIN_BLOCKS_TO_KEEP = 288;
 static const signed int DEFAULT_CHECKBLOCKS = 6;
@@ -319,17 +331,21 @@ private:
     bool cacheStore;
     ScriptError error{SCRIPT_ERR_UNKNOWN_ERROR};
     PrecomputedTransactionData *txdata;
+    //! If set, the first check of the transaction to run computes the hashes in txdata.
+    std::once_flag* m_txdata_once;
 
 public:
-    CScriptCheck(const CTxOut& outIn, const CTransaction& txToIn, unsigned int nInIn, unsigned int nFlagsIn, bool cacheIn, PrecomputedTransactionData* txdataIn) :
-        m_tx_out(outIn), ptxTo(&txToIn), nIn(nInIn), nFlags(nFlagsIn), cacheStore(cacheIn), txdata(txdataIn) { }
+    CScriptCheck(const CTxOut& outIn, const CTransaction& txToIn, unsigned int nInIn, unsigned int nFlagsIn, bool cacheIn, PrecomputedTransactionData* txdataIn, std::once_flag* txdata_once = nullptr) :
+        m_tx_out(outIn), ptxTo(&txToIn), nIn(nInIn), nFlags(nFlagsIn), cacheStore(cacheIn), txdata(txdataIn), m_txdata_once(txdata_once) { }
 
     CScriptCheck(const CScriptCheck&) = delete;
     CScriptCheck& operator=(const CScriptCheck&) = delete;
     CScriptCheck(CScriptCheck&&) = default;
     CScriptCheck& operator=(CScriptCheck&&) = default;
 
-    bool operator()();
+    /** Run the check. If batch is set, Schnorr signatures are added to it
+     *  instead of being verified; the result then depends on its verification. */
+    bool operator()(BatchSchnorrVerifier* batch = nullptr);
 
     ScriptError GetScriptError() const { return error; }
 };
@@ -339,11 +355,47 @@ static_assert(std::is_nothrow_move_assignable_v<CScriptCheck>);
 static_assert(std::is_nothrow_move_constructible_v<CScriptCheck>);
 static_assert(std::is_nothrow_destructible_v<CScriptCheck>);
 
+/**
+ * Run a batch of script checks for CCheckQueue, verifying all their Schnorr
+ * signatures at once if BatchSchnorrVerifier::IsSupported(). If that fails,
+ * the checks are run again one by one so that the failing check reports its
+ * error.
+ */
+bool RunChecks(std::vector<CScriptCheck>& checks);
+
 /** Initializes the script-execution cache */
 [[nodiscard]] bool InitScriptExecutionCache(size_t max_size_bytes);
 
+/** Copy the live entries of the script-execution cache.
+ *  @returns the salt the entries were computed with */
+uint256 GetScriptExecutionCacheEntries(std::vector<uint256>& entries) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+/** Switch the script-execution cache to the given salt and insert entries
+ *  computed with it. Only to be called at startup, before the cache is used. */
+void LoadScriptExecutionCacheEntries(const uint256& nonce, const std::vector<uint256>& entries) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
 /** Functions for validating blocks and updating the block tree */
 
+/** Build the transactions of a block from their deserialized form, computing
+ *  their hashes on several threads for large blocks. */
+void MakeBlockTransactions(std::vector<CMutableTransaction>&& txs, std::vector<CTransactionRef>& vtx);
+
+/**
+ * Deserialize a block, with the same result as `s >> block`, but hashing
+ * the transactions of large blocks on several threads.
+ */
+template <typename Stream>
+void UnserializeBlock(Stream& s, CBlock& block)
+{
+    block.SetNull();
+    s >> AsBase<CBlockHeader>(block);
+    std::vector<CMutableTransaction> txs;
+    for (uint64_t count{ReadCompactSize(s)}; txs.size() < count;) {
+        txs.emplace_back(deserialize, s);
+    }
+    MakeBlockTransactions(std::move(txs), block.vtx);
+}
+
 /** Context-independent validity checks */
 bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, bool fCheckMerkleRoot = true);
 
@@ -794,6 +846,15 @@ enum class SnapshotCompletionResult {
     BASE_BLOCKHASH_MISMATCH,
 };
 
+/** A block found in a block file by ChainstateManager::ScanBlockFile. */
+struct BlockFileRecord {
+    //! Position of the block data, after the record header
+    FlatFilePos pos;
+    //! The block and its hash, computed by the scanning thread
+    std::shared_ptr<CBlock> block;
+    uint256 hash;
+};
+
 /**
  * Provides an interface for creating and interacting with one or two
  * chainstates: an IBD chainstate generated by downloading blocks, and
@@ -878,6 +939,24 @@ private:
         BlockValidationState& state,
         CBlockIndex** ppindex,
         bool min_pow_checked) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /**
+     * Process a block found in a block file by LoadExternalBlockFile or
+     * ScanBlockFile, given its header and hash. read_block is only called,
+     * with cs_main held, when the block itself is needed, and may return
+     * nullptr if it can not be read. Blocks with an unknown parent are added
+     * to blocks_with_unknown_parent, if given, and processed along with their
+     * parent later on.
+     *
+     * @returns   False if the import should stop.
+     */
+    bool ProcessExternalBlock(
+        const CBlockHeader& header,
+        const uint256& hash,
+        const std::function<std::shared_ptr<CBlock>()>& read_block,
+        FlatFilePos* dbp,
+        std::multimap<uint256, FlatFilePos>* blocks_with_unknown_parent,
+        int& loaded);
     friend Chainstate;
 
     /** Most recent headers presync progress update, for rate-limiting. */
@@ -933,9 +1012,15 @@ public:
     const util::SignalInterrupt& m_interrupt;
     const Options m_options;
     std::thread m_thread_load;
+    //! Whether loading the coins cache contents from disk was tried without
+    //! being interrupted, so that they may be dumped again on shutdown.
+    std::atomic_bool m_coins_cache_load_tried{false};
     //! A single BlockManager instance is shared across each constructed
     //! chainstate to avoid duplicating block metadata.
     node::BlockManager m_blockman;
+    //! Loads and checks the blocks about to be connected ahead of time, if
+    //! enabled with -blockprefetch.
+    std::unique_ptr<node::BlockPrefetcher> m_block_prefetcher;
 
     /**
      * Whether initial block download has ended and IsInitialBlockDownload
@@ -1109,6 +1194,23 @@ public:
         FlatFilePos* dbp = nullptr,
         std::multimap<uint256, FlatFilePos>* blocks_with_unknown_parent = nullptr);
 
+    /**
+     * Read the blocks in block file file_num the way LoadExternalBlockFile
+     * does, and compute their hashes. This does not lock cs_main, so -reindex
+     * scans block files ahead on other threads, then processes the records of
+     * each file in order with LoadBlockFileRecords.
+     */
+    std::vector<BlockFileRecord> ScanBlockFile(CAutoFile& file_in, int file_num) const;
+
+    /**
+     * Process the blocks of a block file found by ScanBlockFile, releasing
+     * each one once it is processed. See LoadExternalBlockFile for the
+     * handling of blocks_with_unknown_parent.
+     */
+    void LoadBlockFileRecords(
+        std::vector<BlockFileRecord> records,
+        std::multimap<uint256, FlatFilePos>& blocks_with_unknown_parent);
+
     /**
      * Process an incoming block. This only returns after the best known valid
      * block is made active. Note that it does not, however, guarantee that the
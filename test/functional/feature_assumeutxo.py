@@ -95,8 +95,14 @@ class AssumeutxoTest(OcvcoinTestFramework):
             expected_error(log_msg=f"bad snapshot - coins left over after deserializing 298 coins" if off == -1 else f"bad snapshot format or truncated snapshot after deserializing 299 coins")
 
         self.log.info("  - snapshot file with alternated UTXO data")
+        with open(bad_snapshot_path, "wb") as f:
+            # the first outpoint now sorts after all others
+            f.write(valid_snapshot_contents[:(32 + 8)])
+            f.write(b"\xff" * 32)
+            f.write(valid_snapshot_contents[(32 + 8 + 32):])
+        expected_error(log_msg="[snapshot] bad snapshot - coins not in database order after deserializing 1 coins")
+
         cases = [
-            [b"\xff" * 32, 0, "05030e506678f2eca8d624ffed97090ab3beadad1b51ee6e5985ba91c5720e37"], # wrong outpoint hash
             [(1).to_bytes(4, "little"), 32, "7d29cfe2c1e242bc6f103878bb70cfffa8b4dac20dbd001ff6ce24b7de2d2399"], # wrong outpoint index
             [b"\x81", 36, "f03939a195531f96d5dff983e294a1af62af86049fa7a19a7627246f237c03f1"], # wrong coin code VARINT((coinbase ? 1 : 0) | (height << 1))
             [b"\x83", 36, "e4577da84590fb288c0f7967e89575e1b0aa46624669640f6f5dfef028d39930"], # another wrong coin code
@@ -117,7 +117,8 @@ class MempoolPersistTest(OcvcoinTestFramework):
         # Give this node a head-start, so we can be "extra-sure" that it didn't load anything later
         # Also don't store the mempool, to keep the datadir clean
         self.start_node(1, extra_args=["-persistmempool=0"])
-        self.start_node(0)
+        with self.nodes[0].assert_debug_log(["Loaded validation caches from disk"]):
+            self.start_node(0)
         self.start_node(2)
         assert self.nodes[0].getmempoolinfo()["loaded"]  # start_node is blocking on the mempool being loaded
         assert self.nodes[2].getmempoolinfo()["loaded"]
@@ -49,6 +49,14 @@ class DumptxoutsetTest(OcvcoinTestFramework):
             out['txoutset_hash'], 'a0b7baa3bf5ccbd3279728f230d7ca0c44a76e9923fca8f32dbfd08d65ea496a')
         assert_equal(out['nchaintx'], 101)
 
+        self.log.info("Test the chunked snapshot format")
+        out_chunked = node.dumptxoutset('txoutset_chunked.dat', 2)
+        assert_equal(out_chunked['coins_written'], out['coins_written'])
+        assert_equal(out_chunked['txoutset_hash'], out['txoutset_hash'])
+        chunked_path = node.datadir_path / self.chain / 'txoutset_chunked.dat'
+        assert chunked_path.stat().st_size < expected_path.stat().st_size
+        assert_raises_rpc_error(-8, "Unknown snapshot format 3", node.dumptxoutset, 'txoutset_bad.dat', 3)
+
         # Specifying a path to an existing or invalid file will fail.
         assert_raises_rpc_error(
             -8, '{} already exists'.format(FILENAME),  node.dumptxoutset, FILENAME)
@@ -41,6 +41,10 @@ class RpcMiscTest(OcvcoinTestFramework):
         assert_greater_than(memory['chunks_used'], 0)
         assert_greater_than(memory['chunks_free'], 0)
         assert_equal(memory['used'] + memory['free'], memory['total'])
+        sigcache = node.getmemoryinfo()['sigcache']
+        assert_greater_than(sigcache['shards'], 0)
+        assert_greater_than_or_equal(sigcache['hits'], 0)
+        assert_greater_than_or_equal(sigcache['misses'], 0)
 
         self.log.info("test mallocinfo")
         try: